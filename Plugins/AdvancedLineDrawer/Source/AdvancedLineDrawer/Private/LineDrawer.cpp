@@ -3,6 +3,16 @@
 
 #include "LineDrawer.h"
 
+#include "Algo/BinarySearch.h"
+#include "Algo/Sort.h"
+#include "Algo/Unique.h"
+#include "Async/Async.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+
 int32 GLineDrawerUpdateLineNumInParallel = 8;
 FAutoConsoleVariableRef CVarLineDrawerUpdateLineNumInParallel(
 	TEXT("r.LineDrawerUpdateLineNumInParallel"),
@@ -18,291 +28,4351 @@ FAutoConsoleVariableRef CVarLineDrawerForceSingleThread(
 	TEXT("If true all the parallelisms of line drawer will be disabled.")
 );
 
-void FLineDescriptor::SetCurvePointsWithAutoTangents(const TArray<FVector2f>& Points, float InterpStartT, float InterpEndT, EInterpCurveMode InterpMode, const FSplineTangentSettings& TangentSettings)
+bool GLineDrawerCostBalancedScheduling = true;
+FAutoConsoleVariableRef CVarLineDrawerCostBalancedScheduling(
+	TEXT("r.LineDrawerCostBalancedScheduling"),
+	GLineDrawerCostBalancedScheduling,
+	TEXT("If true the parallel passes are split into batches of similar estimated cost instead of r.LineDrawerUpdateLineNumInParallel lines each.")
+);
+
+bool GLineDrawerAsyncTessellation = false;
+FAutoConsoleVariableRef CVarLineDrawerAsyncTessellation(
+	TEXT("r.LineDrawerAsyncTessellation"),
+	GLineDrawerAsyncTessellation,
+	TEXT("If true lines are tessellated in tasks launched when they change, and painting keeps the last finished geometry of the lines still in flight.")
+);
+
+float GLineDrawerCullingGridCellSize = 256.0f;
+FAutoConsoleVariableRef CVarLineDrawerCullingGridCellSize(
+	TEXT("r.LineDrawerCullingGridCellSize"),
+	GLineDrawerCullingGridCellSize,
+	TEXT("Local space size of the cells of the grid used to cull lines against the clipping rect. Applied the next time the grid is empty."),
+	ECVF_Default
+);
+
+float GLineDrawerRetriangulateTolerance = 0.25f;
+FAutoConsoleVariableRef CVarLineDrawerRetriangulateTolerance(
+	TEXT("r.LineDrawerRetriangulateTolerance"),
+	GLineDrawerRetriangulateTolerance,
+	TEXT("Max error in pixels of the line width before a DrawScale change re-triangulates a line. Smaller changes only re-transform the cached local space geometry."),
+	ECVF_Default
+);
+
+float GLineDrawerBufferPoolSizeMB = 16.0f;
+FAutoConsoleVariableRef CVarLineDrawerBufferPoolSizeMB(
+	TEXT("r.LineDrawerBufferPoolSizeMB"),
+	GLineDrawerBufferPoolSizeMB,
+	TEXT("Max size in MB of the buffers each line drawer keeps from removed lines and finished tessellation jobs to reuse for new ones. 0 disables the pool."),
+	ECVF_Default
+);
+
+float GLineDrawerCompactSlackRatio = 0.25f;
+FAutoConsoleVariableRef CVarLineDrawerCompactSlackRatio(
+	TEXT("r.LineDrawerCompactSlackRatio"),
+	GLineDrawerCompactSlackRatio,
+	TEXT("Compact shrinks the buffers whose unused capacity is above this fraction of their allocated size."),
+	ECVF_Default
+);
+
+int32 GLineDrawerDecimationMinPoints = 2048;
+FAutoConsoleVariableRef CVarLineDrawerDecimationMinPoints(
+	TEXT("r.LineDrawerDecimationMinPoints"),
+	GLineDrawerDecimationMinPoints,
+	TEXT("Lines with fewer points than this are never decimated, whatever the Decimation of their descriptor."),
+	ECVF_Default
+);
+
+int32 GLineDrawerDecimationChunkSize = 32768;
+FAutoConsoleVariableRef CVarLineDrawerDecimationChunkSize(
+	TEXT("r.LineDrawerDecimationChunkSize"),
+	GLineDrawerDecimationChunkSize,
+	TEXT("Number of points decimated by each worker thread. Lines with more points are decimated in parallel."),
+	ECVF_Default
+);
+
+DECLARE_STATS_GROUP(TEXT("LineDrawer"), STATGROUP_LineDrawer, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Render Data Cache Hits"), STAT_LineDrawer_RenderDataCacheHits, STATGROUP_LineDrawer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Render Data Cache Misses"), STAT_LineDrawer_RenderDataCacheMisses, STATGROUP_LineDrawer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Transform Only Updates"), STAT_LineDrawer_TransformOnlyUpdates, STATGROUP_LineDrawer);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Render Data Cache Hit Rate"), STAT_LineDrawer_RenderDataCacheHitRate, STATGROUP_LineDrawer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Draw Elements"), STAT_LineDrawer_DrawElements, STATGROUP_LineDrawer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Visible Lines"), STAT_LineDrawer_VisibleLines, STATGROUP_LineDrawer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Culled Lines"), STAT_LineDrawer_CulledLines, STATGROUP_LineDrawer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Lines In Flight"), STAT_LineDrawer_LinesInFlight, STATGROUP_LineDrawer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Max Visual Lag Frames"), STAT_LineDrawer_MaxVisualLagFrames, STATGROUP_LineDrawer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Lines"), STAT_LineDrawer_Lines, STATGROUP_LineDrawer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Line Commands"), STAT_LineDrawer_LineCommands, STATGROUP_LineDrawer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Coalesced Line Commands"), STAT_LineDrawer_CoalescedLineCommands, STATGROUP_LineDrawer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Re-evaluated Lines"), STAT_LineDrawer_ReEvaluatedLines, STATGROUP_LineDrawer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Re-triangulated Lines"), STAT_LineDrawer_RetriangulatedLines, STATGROUP_LineDrawer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sample Points"), STAT_LineDrawer_SamplePoints, STATGROUP_LineDrawer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Decimated Points"), STAT_LineDrawer_DecimatedPoints, STATGROUP_LineDrawer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Vertices"), STAT_LineDrawer_Vertices, STATGROUP_LineDrawer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Indices"), STAT_LineDrawer_Indices, STATGROUP_LineDrawer);
+DECLARE_MEMORY_STAT(TEXT("Render Data Memory"), STAT_LineDrawer_RenderDataMemory, STATGROUP_LineDrawer);
+DECLARE_MEMORY_STAT(TEXT("Buffer Pool Memory"), STAT_LineDrawer_BufferPoolMemory, STATGROUP_LineDrawer);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Curve Evaluation (ms)"), STAT_LineDrawer_CurveEvaluationTime, STATGROUP_LineDrawer);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Geometry Building (ms)"), STAT_LineDrawer_GeometryBuildingTime, STATGROUP_LineDrawer);
+
+// Memory of the lines, their geometry and the work of the passes on the workers.
+LLM_DEFINE_TAG(LineDrawer);
+
+TRACE_DECLARE_INT_COUNTER(LineDrawer_Lines, TEXT("LineDrawer/Lines"));
+TRACE_DECLARE_INT_COUNTER(LineDrawer_LineCommands, TEXT("LineDrawer/LineCommands"));
+TRACE_DECLARE_INT_COUNTER(LineDrawer_CoalescedLineCommands, TEXT("LineDrawer/CoalescedLineCommands"));
+TRACE_DECLARE_INT_COUNTER(LineDrawer_ReEvaluatedLines, TEXT("LineDrawer/ReEvaluatedLines"));
+TRACE_DECLARE_INT_COUNTER(LineDrawer_RetriangulatedLines, TEXT("LineDrawer/RetriangulatedLines"));
+TRACE_DECLARE_INT_COUNTER(LineDrawer_SamplePoints, TEXT("LineDrawer/SamplePoints"));
+TRACE_DECLARE_INT_COUNTER(LineDrawer_DecimatedPoints, TEXT("LineDrawer/DecimatedPoints"));
+TRACE_DECLARE_INT_COUNTER(LineDrawer_Vertices, TEXT("LineDrawer/Vertices"));
+TRACE_DECLARE_INT_COUNTER(LineDrawer_Indices, TEXT("LineDrawer/Indices"));
+TRACE_DECLARE_MEMORY_COUNTER(LineDrawer_RenderDataMemory, TEXT("LineDrawer/RenderDataMemory"));
+TRACE_DECLARE_MEMORY_COUNTER(LineDrawer_BufferPoolMemory, TEXT("LineDrawer/BufferPoolMemory"));
+TRACE_DECLARE_INT_COUNTER(LineDrawer_DrawElements, TEXT("LineDrawer/DrawElements"));
+TRACE_DECLARE_FLOAT_COUNTER(LineDrawer_CurveEvaluationTime, TEXT("LineDrawer/CurveEvaluationMs"));
+TRACE_DECLARE_FLOAT_COUNTER(LineDrawer_GeometryBuildingTime, TEXT("LineDrawer/GeometryBuildingMs"));
+
+// Work done by all the line drawers since the counters were last published. The atomics are written by the workers, the rest only on the game thread.
+struct FLineDrawerFrameCounters
+{
+	std::atomic<uint32> NumReEvaluatedLines = 0;
+	std::atomic<uint32> NumRetriangulatedLines = 0;
+	// Points dropped by decimation.
+	std::atomic<uint32> NumDecimatedPoints = 0;
+	std::atomic<uint64> CurveEvaluationCycles = 0;
+	std::atomic<uint64> GeometryBuildingCycles = 0;
+	uint32 NumVertices = 0;
+	uint32 NumIndices = 0;
+	uint32 NumDrawElements = 0;
+	// Commands applied, and those of them collapsed into another command of the same line.
+	uint32 NumLineCommands = 0;
+	uint32 NumCoalescedLineCommands = 0;
+	uint64 LastPublishedFrame = MAX_uint64;
+};
+static FLineDrawerFrameCounters GLineDrawerFrameCounters;
+static TArray<ILineDrawer*> GLineDrawers;
+
+struct FScopedLineDrawerCycles
+{
+	explicit FScopedLineDrawerCycles(std::atomic<uint64>& InCycles) : Cycles(InCycles), StartCycles(FPlatformTime::Cycles64()) {}
+	~FScopedLineDrawerCycles() { Cycles.fetch_add(FPlatformTime::Cycles64() - StartCycles, std::memory_order_relaxed); }
+
+	std::atomic<uint64>& Cycles;
+	const uint64 StartCycles;
+};
+
+static FAutoConsoleCommand CmdLineDrawerDumpExpensiveLines(
+	TEXT("r.LineDrawerDumpExpensiveLines"),
+	TEXT("Logs the most expensive lines of every line drawer with their key, sample and vertex counts. Optional argument: number of lines per drawer, 20 by default."),
+	FConsoleCommandWithArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, FOutputDevice& Ar)
+	{
+		ILineDrawer::DumpExpensiveLines(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 20, Ar);
+	})
+);
+
+static FAutoConsoleCommand CmdLineDrawerMemReport(
+	TEXT("r.LineDrawerMemReport"),
+	TEXT("Logs the memory used by every line drawer, split by buffer kind, with the size of its buffer pool and the slack Compact would free."),
+	FConsoleCommandWithArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, FOutputDevice& Ar)
+	{
+		ILineDrawer::DumpMemoryReport(Ar);
+	})
+);
+
+static FAutoConsoleCommand CmdLineDrawerCompact(
+	TEXT("r.LineDrawerCompact"),
+	TEXT("Compacts every line drawer, see r.LineDrawerCompactSlackRatio."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		for (ILineDrawer* LineDrawer : GLineDrawers)
+		{
+			LineDrawer->Compact();
+		}
+	})
+);
+
+static constexpr float LineAntiAliasingFilterRadius = 2.0f;
+static constexpr float LineMiterAngleLimit = 90.0f - KINDA_SMALL_NUMBER;
+static constexpr int32 AutoTangentChunkSize = 16384;
+static constexpr float StreamingArcLengthRebaseStep = 4096.0f;
+static constexpr float DynamicResolutionUnitCube = 512.0f * 512.0f * 512.0f;
+static constexpr int32 MaxSubdivisionDepth = 12;
+// Bump whenever the samples of a curve change for the same keys and parameters, snapshots saved before then sample their lines again.
+static constexpr uint32 CurveSamplerVersion = 1;
+
+// Layout of the blob of SaveLinesSnapshot: the header, then the line records and the arrays they index into, each starting on
+// LinesSnapshotAlignment bytes. Bump the version whenever the layout changes.
+static constexpr uint32 LinesSnapshotMagic = 0x534C444C;
+static constexpr uint32 LinesSnapshotVersion = 6;
+static constexpr int64 LinesSnapshotAlignment = 16;
+static constexpr uint32 LinesSnapshotByteOrderMark = 0x01020304;
+// Lines keep their indices through a snapshot, so the holes between them are loaded too. Blobs with more than this many slots per
+// line, past the first few, are rejected rather than allocated.
+static constexpr int32 LinesSnapshotMaxSlotsPerLine = 64;
+static constexpr int32 LinesSnapshotMinSlots = 1024;
+
+// The arrays are copied as they are in memory, so a blob is only read by builds with the same byte order and sizes of the types
+// it holds. Nothing is converted, a blob of another platform is rejected.
+struct FLinesSnapshotFormat
+{
+	uint32 ByteOrderMark;
+	uint32 SizeOfLineRecord;
+	uint32 SizeOfCurveKey;
+	uint32 SizeOfSlateVertex;
+	uint32 SizeOfSlateIndex;
+	uint32 SizeOfRenderTransform;
+};
+
+struct FLinesSnapshotHeader
+{
+	uint32 Magic;
+	uint32 Version;
+	FLinesSnapshotFormat Format;
+	// The samples and geometry of the lines are only kept by a build with the same sampler and geometry constants.
+	uint32 SamplerHash;
+	// GetMaxIndex of the lines saved from, every line index is below it.
+	int32 MaxLineIndex;
+	int32 NumLines;
+	int32 NumBrushes;
+	int32 BrushTableBytes;
+	int32 NumKeys;
+	int32 NumSamples;
+	int32 NumIntervalOffsets;
+	int32 NumPolylinePoints;
+	int32 NumVertices;
+	int32 NumIndices;
+};
+
+// Everything of a line but its arrays, which are ranges of the arrays of the blob.
+struct FLinesSnapshotLine
+{
+	int32 LineIndex;
+	int32 BrushIndex;
+	int32 FirstKey;
+	int32 NumKeys;
+	int32 FirstSample;
+	int32 NumSamples;
+	int32 FirstIntervalOffset;
+	int32 NumIntervalOffsets;
+	// INDEX_NONE for curves.
+	int32 FirstPolylinePoint;
+	int32 NumPolylinePoints;
+	int32 FirstVertex;
+	int32 NumVertices;
+	int32 FirstIndex;
+	int32 NumIndices;
+	int32 FirstSampledKey;
+	float DynamicResolutionScale;
+	float LocalTolerance;
+	float LineLength;
+	float SampleDrawScale;
+	FVector2f SampleBoundsMin;
+	FVector2f SampleBoundsMax;
+	float LocalGeometryDrawScale;
+	float GeometryThickness;
+	FSlateRenderTransform RenderDataTransform;
+	FColor VertexColor;
+	float Thickness;
+	float Resolution;
+	float DynamicResolutionFactor;
+	float MaxResolution;
+	float TessellationTolerance;
+	float DecimationTolerance;
+	float InterpCurveStartT;
+	float InterpCurveEndT;
+	float LoopKeyOffset;
+	ELineTessellationMode TessellationMode;
+	ELineDecimationMode Decimation;
+	// 0 or 1, read from the blob as bytes.
+	uint8 bIsLooped;
+	uint8 bSampled;
+	uint8 bHasSampleBounds;
+};
+
+struct FLinesSnapshotLayout
+{
+	explicit FLinesSnapshotLayout(const FLinesSnapshotHeader& Header)
+	{
+		int64 Offset = 0;
+		auto AddSection = [&Offset](int64 NumBytes)
+		{
+			const int64 SectionOffset = Align(Offset, LinesSnapshotAlignment);
+			Offset = SectionOffset + NumBytes;
+			return SectionOffset;
+		};
+		AddSection(sizeof(FLinesSnapshotHeader));
+		Lines = AddSection(static_cast<int64>(Header.NumLines) * sizeof(FLinesSnapshotLine));
+		Keys = AddSection(static_cast<int64>(Header.NumKeys) * sizeof(FInterpCurvePoint<FVector2f>));
+		Samples = AddSection(static_cast<int64>(Header.NumSamples) * sizeof(FVector2f));
+		IntervalOffsets = AddSection(static_cast<int64>(Header.NumIntervalOffsets) * sizeof(int32));
+		PolylinePoints = AddSection(static_cast<int64>(Header.NumPolylinePoints) * sizeof(FVector2f));
+		LocalPositionX = AddSection(static_cast<int64>(Header.NumVertices) * sizeof(float));
+		LocalPositionY = AddSection(static_cast<int64>(Header.NumVertices) * sizeof(float));
+		Vertices = AddSection(static_cast<int64>(Header.NumVertices) * sizeof(FSlateVertex));
+		Indices = AddSection(static_cast<int64>(Header.NumIndices) * sizeof(SlateIndex));
+		Brushes = AddSection(Header.BrushTableBytes);
+		TotalBytes = Offset;
+	}
+
+	int64 Lines, Keys, Samples, IntervalOffsets, PolylinePoints, LocalPositionX, LocalPositionY, Vertices, Indices, Brushes, TotalBytes;
+};
+
+static FLinesSnapshotFormat GetLinesSnapshotFormat()
+{
+	FLinesSnapshotFormat Format;
+	Format.ByteOrderMark = LinesSnapshotByteOrderMark;
+	Format.SizeOfLineRecord = sizeof(FLinesSnapshotLine);
+	Format.SizeOfCurveKey = sizeof(FInterpCurvePoint<FVector2f>);
+	Format.SizeOfSlateVertex = sizeof(FSlateVertex);
+	Format.SizeOfSlateIndex = sizeof(SlateIndex);
+	Format.SizeOfRenderTransform = sizeof(FSlateRenderTransform);
+	return Format;
+}
+
+static uint32 GetLinesSnapshotSamplerHash()
+{
+	uint32 Hash = GetTypeHash(CurveSamplerVersion);
+	Hash = HashCombineFast(Hash, GetTypeHash(DynamicResolutionUnitCube));
+	Hash = HashCombineFast(Hash, GetTypeHash(MaxSubdivisionDepth));
+	Hash = HashCombineFast(Hash, GetTypeHash(LineAntiAliasingFilterRadius));
+	Hash = HashCombineFast(Hash, GetTypeHash(LineMiterAngleLimit));
+	return Hash;
+}
+
+template <typename T>
+static TArrayView<T> GetLinesSnapshotSection(TArrayView<uint8> Data, int64 Offset, int32 Num)
+{
+	return TArrayView<T>(reinterpret_cast<T*>(Data.GetData() + Offset), Num);
+}
+
+template <typename T>
+static TConstArrayView<T> GetLinesSnapshotSection(TConstArrayView<uint8> Data, int64 Offset, int32 Num)
+{
+	return TConstArrayView<T>(reinterpret_cast<const T*>(Data.GetData() + Offset), Num);
+}
+
+// Same expressions as the one key at a time reference of the benchmark, so the keys come out with the same bits.
+template <bool bLinear>
+static FVector2f GetAutoLeaveTangent(const FVector2f* Points, int32 Index, const FSplineTangentSettings& TangentSettings)
+{
+	const FVector2f DeltaPos = Points[Index + 1] - Points[Index];
+	if constexpr (bLinear)
+	{
+		return DeltaPos;
+	}
+	else
+	{
+		const float ClampedTensionX = FMath::Min<float>(FMath::Abs<float>(DeltaPos.X), TangentSettings.SplineHorizontalDeltaRange);
+		const float ClampedTensionY = FMath::Min<float>(FMath::Abs<float>(DeltaPos.Y), TangentSettings.SplineVerticalDeltaRange);
+		return (ClampedTensionX * TangentSettings.SplineTangentFromHorizontalDelta + ClampedTensionY * TangentSettings.SplineTangentFromVerticalDelta) * FVector2f(FMath::Sign(DeltaPos.X), FMath::Sign(DeltaPos.Y));
+	}
+}
+
+template <bool bLinear, bool bTranspose>
+static FVector2f GetAutoArriveTangent(const FVector2f* Points, int32 Index, const FVector2f& PrevLeaveTangent)
+{
+	if (Index == 0)
+	{
+		return FVector2f::Zero();
+	}
+	if constexpr (bLinear)
+	{
+		return -PrevLeaveTangent;
+	}
+	else if constexpr (bTranspose)
+	{
+		return FVector2f(-PrevLeaveTangent.Y, Points[Index].X - Points[Index - 1].X > 0 ? PrevLeaveTangent.X : -PrevLeaveTangent.X);
+	}
+	else
+	{
+		return FVector2f(PrevLeaveTangent.X, -PrevLeaveTangent.Y);
+	}
+}
+
+template <bool bLinear, bool bTranspose>
+static void WriteAutoTangentKeys(const FVector2f* Points, int32 NumPoints, int32 Begin, int32 End, float InterpStartT, float InterpEndT, EInterpCurveMode InterpMode, const FSplineTangentSettings& TangentSettings, FInterpCurvePoint<FVector2f>* OutKeys)
+{
+	// Leave tangents first, two keys per register. Every lane goes through the same operations as the scalar version.
+	const int32 LeaveEnd = FMath::Min(End, NumPoints - 1);
+	int32 Index = Begin;
+	if constexpr (!bLinear)
+	{
+		const VectorRegister4Float DeltaRange = MakeVectorRegisterFloat(TangentSettings.SplineHorizontalDeltaRange, TangentSettings.SplineVerticalDeltaRange, TangentSettings.SplineHorizontalDeltaRange, TangentSettings.SplineVerticalDeltaRange);
+		const FVector2f& FromHorizontal = TangentSettings.SplineTangentFromHorizontalDelta;
+		const FVector2f& FromVertical = TangentSettings.SplineTangentFromVerticalDelta;
+		const VectorRegister4Float TangentFromHorizontal = MakeVectorRegisterFloat(FromHorizontal.X, FromHorizontal.Y, FromHorizontal.X, FromHorizontal.Y);
+		const VectorRegister4Float TangentFromVertical = MakeVectorRegisterFloat(FromVertical.X, FromVertical.Y, FromVertical.X, FromVertical.Y);
+		alignas(16) float Tangents[4];
+		for (; Index + 1 < LeaveEnd; Index += 2)
+		{
+			const VectorRegister4Float Delta = VectorSubtract(VectorLoad(&Points[Index + 1].X), VectorLoad(&Points[Index].X));
+			const VectorRegister4Float Tension = VectorMin(VectorAbs(Delta), DeltaRange);
+			// FMath::Sign, which is 0 for 0.
+			const VectorRegister4Float Sign = VectorSubtract(
+				VectorBitwiseAnd(VectorCompareGT(Delta, GlobalVectorConstants::FloatZero), GlobalVectorConstants::FloatOne),
+				VectorBitwiseAnd(VectorCompareLT(Delta, GlobalVectorConstants::FloatZero), GlobalVectorConstants::FloatOne));
+			const VectorRegister4Float TensionX = VectorSwizzle(Tension, 0, 0, 2, 2);
+			const VectorRegister4Float TensionY = VectorSwizzle(Tension, 1, 1, 3, 3);
+			VectorStoreAligned(VectorMultiply(VectorAdd(VectorMultiply(TensionX, TangentFromHorizontal), VectorMultiply(TensionY, TangentFromVertical)), Sign), Tangents);
+			OutKeys[Index].LeaveTangent = FVector2f(Tangents[0], Tangents[1]);
+			OutKeys[Index + 1].LeaveTangent = FVector2f(Tangents[2], Tangents[3]);
+		}
+	}
+	for (; Index < LeaveEnd; ++Index)
+	{
+		OutKeys[Index].LeaveTangent = GetAutoLeaveTangent<bLinear>(Points, Index, TangentSettings);
+	}
+	if (End == NumPoints)
+	{
+		OutKeys[NumPoints - 1].LeaveTangent = FVector2f::Zero();
+	}
+
+	// The arrive tangent of a key comes from the leave tangent of the previous one, which belongs to the previous block at the start.
+	FVector2f PrevLeaveTangent = Begin > 0 ? GetAutoLeaveTangent<bLinear>(Points, Begin - 1, TangentSettings) : FVector2f::Zero();
+	for (Index = Begin; Index < End; ++Index)
+	{
+		FInterpCurvePoint<FVector2f>& Key = OutKeys[Index];
+		Key.InVal = FMath::Lerp(InterpStartT, InterpEndT, NumPoints > 1 ? static_cast<float>(Index) / (NumPoints - 1) : 1.0f);
+		Key.OutVal = Points[Index];
+		Key.ArriveTangent = GetAutoArriveTangent<bLinear, bTranspose>(Points, Index, PrevLeaveTangent);
+		Key.InterpMode = InterpMode;
+		PrevLeaveTangent = Key.LeaveTangent;
+	}
+}
+
+void FLineDescriptor::SetCurvePointsWithAutoTangents(const TArray<FVector2f>& Points, float InterpStartT, float InterpEndT, EInterpCurveMode InterpMode, const FSplineTangentSettings& TangentSettings)
+{
+	const int32 NumPoints = Points.Num();
+	InterpCurve.Points.SetNumUninitialized(NumPoints);
+	if (NumPoints == 0)
+	{
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(FLineDescriptor::SetCurvePointsWithAutoTangents);
+
+	auto WriteKeys = [&Points, NumPoints, InterpStartT, InterpEndT, InterpMode, &TangentSettings, OutKeys = InterpCurve.Points.GetData()](int32 Begin, int32 End)
+	{
+		if (InterpMode == CIM_Linear)
+		{
+			WriteAutoTangentKeys<true, false>(Points.GetData(), NumPoints, Begin, End, InterpStartT, InterpEndT, InterpMode, TangentSettings, OutKeys);
+		}
+		else if (TangentSettings.bTranspose)
+		{
+			WriteAutoTangentKeys<false, true>(Points.GetData(), NumPoints, Begin, End, InterpStartT, InterpEndT, InterpMode, TangentSettings, OutKeys);
+		}
+		else
+		{
+			WriteAutoTangentKeys<false, false>(Points.GetData(), NumPoints, Begin, End, InterpStartT, InterpEndT, InterpMode, TangentSettings, OutKeys);
+		}
+	};
+
+	// A key only depends on its neighbour points, so the blocks can be written in any order.
+	const int32 NumChunks = FMath::DivideAndRoundUp(NumPoints, AutoTangentChunkSize);
+	if (NumChunks <= 1 || GLineDrawerForceSingleThread)
+	{
+		WriteKeys(0, NumPoints);
+		return;
+	}
+
+	ParallelFor(TEXT("FLineDescriptor::ParallelSetCurvePointsWithAutoTangents"), NumChunks, 1, [&WriteKeys, NumPoints](int32 ChunkIndex)
+	{
+		LLM_SCOPE_BYTAG(LineDrawer);
+		const int32 Begin = ChunkIndex * AutoTangentChunkSize;
+		WriteKeys(Begin, FMath::Min(Begin + AutoTangentChunkSize, NumPoints));
+	});
+}
+
+int32 FLineDescriptor::AddPoint(const FVector2f& Point, float InterpT, EInterpCurveMode InterpMode, const FVector2f& ArriveTangent, const FVector2f& LeaveTangent)
+{
+	const int32 NewCurvePointIndex = InterpCurve.AddPoint(InterpT, Point);
+	auto& NewCurvePoint = InterpCurve.Points[NewCurvePointIndex];
+
+	NewCurvePoint.InterpMode = InterpMode;
+	NewCurvePoint.ArriveTangent = ArriveTangent;
+	NewCurvePoint.LeaveTangent = LeaveTangent;
+
+	return NewCurvePointIndex;
+}
+
+void FLineDescriptor::SetPoint(int32 PointIndex, const FVector2f& Point)
+{
+	const auto& CurvePoint = InterpCurve.Points[PointIndex];
+	SetPoint(PointIndex, Point, CurvePoint.ArriveTangent, CurvePoint.LeaveTangent);
+}
+
+void FLineDescriptor::SetPoint(int32 PointIndex, const FVector2f& Point, const FVector2f& ArriveTangent, const FVector2f& LeaveTangent)
+{
+	auto& CurvePoint = InterpCurve.Points[PointIndex];
+	CurvePoint.OutVal = Point;
+	CurvePoint.ArriveTangent = ArriveTangent;
+	CurvePoint.LeaveTangent = LeaveTangent;
+}
+
+void FLineDescriptor::SetPolylinePoints(TSharedPtr<const TArray<FVector2f>> Points)
+{
+	PolylinePoints = MoveTemp(Points);
+}
+
+void FLineDescriptor::SetPolylinePoints(TArray<FVector2f>&& Points)
+{
+	SetPolylinePoints(MakeShared<TArray<FVector2f>>(MoveTemp(Points)));
+}
+
+ILineDrawer::ILineDrawer()
+{
+	GLineDrawers.Add(this);
+}
+
+ILineDrawer::~ILineDrawer()
+{
+	GLineDrawers.RemoveSingleSwap(this);
+	if (LineSource)
+	{
+		LineSource->LineViews.RemoveSingleSwap(this);
+	}
+	for (ILineDrawer* LineView : LineViews)
+	{
+		LineView->LineSource = nullptr;
+		LineView->RemoveAllLines();
+	}
+}
+
+int32 ILineDrawer::AddLine(const FLineDescriptor& LineDescriptor)
+{
+	return AddLine(FLineDescriptor(LineDescriptor));
+}
+
+int32 ILineDrawer::AddLine(FLineDescriptor&& LineDescriptor)
+{
+	if (!EnsureNotLineView())
+	{
+		return INDEX_NONE;
+	}
+
+	LLM_SCOPE_BYTAG(LineDrawer);
+	const int32 LineIndex = EmplaceLine(MoveTemp(LineDescriptor));
+	KickTessellationJobs();
+	InvalidateLineDrawer();
+	return LineIndex;
+}
+
+TArray<int32> ILineDrawer::AddLines(TConstArrayView<FLineDescriptor> LineDescriptors)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::AddLines);
+	if (!EnsureNotLineView())
+	{
+		return TArray<int32>();
+	}
+
+	LLM_SCOPE_BYTAG(LineDrawer);
+
+	ReserveLines(LineDescriptors.Num());
+	TArray<int32> LineIndices;
+	LineIndices.Reserve(LineDescriptors.Num());
+	for (const FLineDescriptor& LineDescriptor : LineDescriptors)
+	{
+		LineIndices.Add(EmplaceLine(FLineDescriptor(LineDescriptor)));
+	}
+
+	KickTessellationJobs();
+	InvalidateLineDrawer();
+	return LineIndices;
+}
+
+TArray<int32> ILineDrawer::AddLines(TArray<FLineDescriptor>&& LineDescriptors)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::AddLines);
+	if (!EnsureNotLineView())
+	{
+		return TArray<int32>();
+	}
+
+	LLM_SCOPE_BYTAG(LineDrawer);
+
+	ReserveLines(LineDescriptors.Num());
+	TArray<int32> LineIndices;
+	LineIndices.Reserve(LineDescriptors.Num());
+	for (FLineDescriptor& LineDescriptor : LineDescriptors)
+	{
+		LineIndices.Add(EmplaceLine(MoveTemp(LineDescriptor)));
+	}
+	LineDescriptors.Reset();
+
+	KickTessellationJobs();
+	InvalidateLineDrawer();
+	return LineIndices;
+}
+
+bool ILineDrawer::UpdateLine(int32 LineIndex, TFunctionRef<bool(FLineDescriptor& OutLineDescriptor)> Updater)
+{
+	if (!EnsureNotLineView() || !LineDatas.IsValidIndex(LineIndex))
+	{
+		return false;
+	}
+
+	LLM_SCOPE_BYTAG(LineDrawer);
+	if (Updater(LineDatas[LineIndex].LineDescriptor))
+	{
+		MarkLineChanged(LineIndex);
+		KickTessellationJobs();
+		InvalidateLineDrawer();
+	}
+
+	return true;
+}
+
+int32 ILineDrawer::UpdateLines(TConstArrayView<int32> LineIndices, TFunctionRef<bool(int32 LineIndex, FLineDescriptor& OutLineDescriptor)> Updater)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::UpdateLines);
+	if (!EnsureNotLineView())
+	{
+		return 0;
+	}
+
+	LLM_SCOPE_BYTAG(LineDrawer);
+
+	int32 NumUpdatedLines = 0;
+	bool bAnyLineChanged = false;
+	for (const int32 LineIndex : LineIndices)
+	{
+		if (!LineDatas.IsValidIndex(LineIndex))
+		{
+			continue;
+		}
+
+		++NumUpdatedLines;
+		if (Updater(LineIndex, LineDatas[LineIndex].LineDescriptor))
+		{
+			MarkLineChanged(LineIndex);
+			bAnyLineChanged = true;
+		}
+	}
+
+	if (bAnyLineChanged)
+	{
+		KickTessellationJobs();
+		InvalidateLineDrawer();
+	}
+
+	return NumUpdatedLines;
+}
+
+bool ILineDrawer::SetLineColor(int32 LineIndex, const FLinearColor& Color)
+{
+	return UpdateLine(LineIndex, [&Color](FLineDescriptor& OutLineDescriptor)
+	{
+		OutLineDescriptor.Brush.TintColor = Color;
+		return true;
+	});
+}
+
+void ILineDrawer::SetLinesColor(TConstArrayView<int32> LineIndices, const FLinearColor& Color)
+{
+	UpdateLines(LineIndices, [&Color](int32, FLineDescriptor& OutLineDescriptor)
+	{
+		OutLineDescriptor.Brush.TintColor = Color;
+		return true;
+	});
+}
+
+bool ILineDrawer::SetLineThickness(int32 LineIndex, float Thickness)
+{
+	return UpdateLine(LineIndex, [Thickness](FLineDescriptor& OutLineDescriptor)
+	{
+		OutLineDescriptor.Thickness = Thickness;
+		return true;
+	});
+}
+
+int32 ILineDrawer::AddStreamingLine(FLineDescriptor&& LineDescriptor, int32 Capacity)
+{
+	if (!EnsureNotLineView())
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 LineIndex = EmplaceLine(MoveTemp(LineDescriptor));
+	FLineData& LineData = LineDatas[LineIndex];
+	LineData.Streaming = MakeUnique<FStreamingLine>();
+	LineData.Streaming->Capacity = FMath::Max(Capacity, 2);
+	StreamingLines.Add(LineIndex);
+	InvalidateLineDrawer();
+	return LineIndex;
+}
+
+bool ILineDrawer::AppendPoints(int32 LineIndex, TConstArrayView<FVector2f> Points)
+{
+	if (!EnsureNotLineView() || !LineDatas.IsValidIndex(LineIndex) || !LineDatas[LineIndex].Streaming || Points.Num() == 0)
+	{
+		return false;
+	}
+
+	LLM_SCOPE_BYTAG(LineDrawer);
+	FLineData& LineData = LineDatas[LineIndex];
+	FStreamingLine& Stream = *LineData.Streaming;
+	float ArcLength = Stream.ArcLengths.Num() > 0 ? Stream.ArcLengths.Last() : 0.0f;
+	FVector2f LastPoint = Stream.Points.Num() > 0 ? Stream.Points.Last() : Points[0];
+	for (const FVector2f& Point : Points)
+	{
+		ArcLength += FVector2f::Distance(LastPoint, Point);
+		Stream.Points.Add(Point);
+		Stream.ArcLengths.Add(ArcLength);
+		LineData.SampleBounds += Point;
+		LastPoint = Point;
+	}
+	const int32 NumPoints = Stream.Points.Num();
+	Stream.FirstVertices.SetNum(NumPoints, EAllowShrinking::No);
+	Stream.FirstIndices.SetNum(NumPoints, EAllowShrinking::No);
+	Stream.MiterJoins.SetNum(NumPoints, EAllowShrinking::No);
+
+	if (NumPoints - Stream.HeadPoint > Stream.Capacity * 2)
+	{
+		// Not painted for a while, drop what scrolled out and rebuild the line on the next paint.
+		FRenderData& RenderData = LineData.RenderData;
+		RenderData.LocalPositionX.Reset();
+		RenderData.LocalPositionY.Reset();
+		RenderData.VertexData.Reset();
+		RenderData.IndexData.Reset();
+		Stream.HeadPoint = NumPoints - Stream.Capacity;
+		Stream.NumBuiltPoints = Stream.TailVertex = Stream.TailIndex = Stream.NumDeadVertices = Stream.NumDeadIndices = 0;
+		CompactStreamingLine(LineData, true);
+		LineData.bNeedRebuildLocalGeometry = true;
+	}
+
+	LineData.LineLength = ArcLength - Stream.ArcLengths[Stream.HeadPoint];
+	LineData.SegmentChunkBounds.Reset();
+	LineData.bNeedUpdateSpatialGrid = true;
+	++LineData.DataGeneration;
+	// Streaming lines only reach the spatial grid when the source itself is painted.
+	NotifyLineViews(LineIndex);
+	InvalidateLineDrawer();
+	return true;
+}
+
+int32 ILineDrawer::AddLineShape(FLineDescriptor&& LineDescriptor)
+{
+	if (!EnsureNotLineView())
+	{
+		return INDEX_NONE;
+	}
+
+	FLineShape NewShape;
+	NewShape.LineData.LineDescriptor = MoveTemp(LineDescriptor);
+	NewShape.LineData.bNeedReEvalInterpCurve = true;
+	NewShape.LineData.Serial = ++NextLineSerial;
+	return LineShapes.Emplace(MoveTemp(NewShape));
+}
+
+bool ILineDrawer::UpdateLineShape(int32 ShapeIndex, TFunctionRef<bool(FLineDescriptor& OutLineDescriptor)> Updater)
+{
+	if (!EnsureNotLineView() || !LineShapes.IsValidIndex(ShapeIndex))
+	{
+		return false;
+	}
+
+	FLineShape& Shape = LineShapes[ShapeIndex];
+	FLineData& ShapeData = Shape.LineData;
+	if (!Updater(ShapeData.LineDescriptor))
+	{
+		return true;
+	}
+
+	// Shapes are few, so any change simply rebuilds the shape and re-copies it into its instances.
+	if (!IsCurveSampled(ShapeData))
+	{
+		ShapeData.bNeedReEvalInterpCurve = true;
+	}
+	ShapeData.bNeedRebuildLocalGeometry = true;
+	for (const int32 LineIndex : Shape.Instances)
+	{
+		FLineData& LineData = LineDatas[LineIndex];
+		SetLineInstanceDescriptor(ShapeData.LineDescriptor, *LineData.Instance, LineData.LineDescriptor);
+		LineData.RenderData.RenderingResourceHandle = FSlateResourceHandle();
+		LineData.bNeedRebuildLocalGeometry = true;
+		++LineData.DataGeneration;
+		HotStore.MarkRenderDataStale(LineIndex);
+	}
+	bDrawBatchesDirty = true;
+	InvalidateLineDrawer();
+	return true;
+}
+
+void ILineDrawer::RemoveLineShape(int32 ShapeIndex)
+{
+	if (!EnsureNotLineView() || !LineShapes.IsValidIndex(ShapeIndex))
+	{
+		return;
+	}
+
+	RemoveLines(TArray<int32>(LineShapes[ShapeIndex].Instances));
+	LineShapes.RemoveAt(ShapeIndex);
+}
+
+int32 ILineDrawer::AddLineInstance(int32 ShapeIndex, const FSlateRenderTransform& Transform, const FLinearColor& Tint)
+{
+	if (!EnsureNotLineView() || !LineShapes.IsValidIndex(ShapeIndex))
+	{
+		return INDEX_NONE;
+	}
+
+	FLineData NewLineData;
+	NewLineData.Instance = MakeUnique<FLineInstance>();
+	NewLineData.Instance->ShapeIndex = ShapeIndex;
+	NewLineData.Instance->Transform = Transform;
+	NewLineData.Instance->Tint = Tint;
+	SetLineInstanceDescriptor(LineShapes[ShapeIndex].LineData.LineDescriptor, *NewLineData.Instance, NewLineData.LineDescriptor);
+	NewLineData.bNeedRebuildLocalGeometry = true;
+	NewLineData.Serial = ++NextLineSerial;
+
+	const int32 LineIndex = LineDatas.Emplace(MoveTemp(NewLineData));
+	HotStore.Add(LineIndex);
+	LineShapes[ShapeIndex].Instances.Add(LineIndex);
+	// Instances of a shape that is not sampled yet enter the spatial grid once it is, on the next paint.
+	UpdateLineInstanceBounds(LineIndex);
+	bDrawBatchesDirty = true;
+	InvalidateLineDrawer();
+	return LineIndex;
+}
+
+bool ILineDrawer::SetLineInstanceTransform(int32 LineIndex, const FSlateRenderTransform& Transform)
+{
+	if (!LineDatas.IsValidIndex(LineIndex) || !LineDatas[LineIndex].Instance)
+	{
+		return false;
+	}
+
+	FLineData& LineData = LineDatas[LineIndex];
+	const FLineData& ShapeData = LineShapes[LineData.Instance->ShapeIndex].LineData;
+	LineData.Instance->Transform = Transform;
+	SetLineInstanceDescriptor(ShapeData.LineDescriptor, *LineData.Instance, LineData.LineDescriptor);
+	if (!LineData.bNeedRebuildLocalGeometry)
+	{
+		// With the render transform of the last paint, the update pass of the next one redoes it if the widget moved since.
+		const FRenderData& ShapeRenderData = ShapeData.RenderData;
+		TransformVertices(ShapeRenderData.LocalPositionX.GetData(), ShapeRenderData.LocalPositionY.GetData(), LineData.RenderData.VertexData.GetData(), LineData.RenderData.VertexData.Num(),
+			::Concatenate(Transform, LineData.RenderDataTransform), ESlateVertexRounding::Enabled);
+	}
+	++LineData.DataGeneration;
+	UpdateLineInstanceBounds(LineIndex);
+	bDrawBatchesDirty = true;
+	InvalidateLineDrawer();
+	return true;
+}
+
+bool ILineDrawer::SetLineInstanceTint(int32 LineIndex, const FLinearColor& Tint)
+{
+	if (!LineDatas.IsValidIndex(LineIndex) || !LineDatas[LineIndex].Instance)
+	{
+		return false;
+	}
+
+	return UpdateLine(LineIndex, [this, &Tint, &LineData = LineDatas[LineIndex]](FLineDescriptor& OutLineDescriptor)
+	{
+		LineData.Instance->Tint = Tint;
+		SetLineInstanceDescriptor(LineShapes[LineData.Instance->ShapeIndex].LineData.LineDescriptor, *LineData.Instance, OutLineDescriptor);
+		return true;
+	});
+}
+
+void ILineDrawer::SetLineSource(ILineDrawer* Source)
+{
+	check(Source != this && (!Source || !Source->LineSource) && LineViews.Num() == 0);
+	if (Source == LineSource)
+	{
+		return;
+	}
+
+	if (LineSource)
+	{
+		LineSource->LineViews.RemoveSingleSwap(this);
+	}
+	RemoveAllLines();
+	LineSource = Source;
+	PendingSourceLines.Reset();
+	if (LineSource)
+	{
+		LineSource->LineViews.Add(this);
+		PendingSourceLines.Init(false, LineSource->LineDatas.GetMaxIndex());
+		for (auto It = LineSource->LineDatas.CreateConstIterator(); It; ++It)
+		{
+			PendingSourceLines[It.GetIndex()] = true;
+		}
+	}
+}
+
+TArray<int32> ILineDrawer::ReserveLineHandles(int32 NumHandles)
+{
+	check(IsInGameThread() && NumHandles > 0);
+	if (!LineCommandsWidget.IsValid())
+	{
+		LineCommandsWidget = GetLineDrawerWidget().AsShared();
+	}
+
+	TArray<int32> LineHandles;
+	LineHandles.Reserve(NumHandles);
+	const int32 NumRecycled = FMath::Min(NumHandles, FreeLineHandles.Num());
+	LineHandles.Append(TConstArrayView<int32>(FreeLineHandles).Right(NumRecycled));
+	FreeLineHandles.SetNum(FreeLineHandles.Num() - NumRecycled, EAllowShrinking::No);
+	const int32 FirstNewHandle = NextLineHandle.fetch_add(NumHandles - NumRecycled, std::memory_order_relaxed);
+	for (int32 LineHandle = FirstNewHandle; LineHandle < FirstNewHandle + NumHandles - NumRecycled; ++LineHandle)
+	{
+		LineHandles.Add(LineHandle);
+	}
+	return LineHandles;
+}
+
+void ILineDrawer::EnqueueAddLine(int32 LineHandle, FLineDescriptor&& LineDescriptor)
+{
+	EnqueueLineCommand(ELineCommand::Add, LineHandle, MoveTemp(LineDescriptor));
+}
+
+void ILineDrawer::EnqueueUpdateLine(int32 LineHandle, FLineDescriptor&& LineDescriptor)
+{
+	EnqueueLineCommand(ELineCommand::Update, LineHandle, MoveTemp(LineDescriptor));
+}
+
+void ILineDrawer::EnqueueRemoveLine(int32 LineHandle)
+{
+	EnqueueLineCommand(ELineCommand::Remove, LineHandle, FLineDescriptor());
+}
+
+void ILineDrawer::EnqueueReleaseLineHandle(int32 LineHandle)
+{
+	EnqueueLineCommand(ELineCommand::Release, LineHandle, FLineDescriptor());
+}
+
+void ILineDrawer::FlushLineCommands()
+{
+	check(IsInGameThread());
+	LLM_SCOPE_BYTAG(LineDrawer);
+	if (ApplyLineCommands())
+	{
+		KickTessellationJobs();
+		InvalidateLineDrawer();
+	}
+}
+
+int32 ILineDrawer::GetLineOfHandle(int32 LineHandle) const
+{
+	const int32* LineIndex = HandleLines.Find(LineHandle);
+	return LineIndex ? *LineIndex : INDEX_NONE;
+}
+
+void ILineDrawer::EnqueueLineCommand(ELineCommand Command, int32 LineHandle, FLineDescriptor&& LineDescriptor)
+{
+	if (!EnsureNotLineView())
+	{
+		return;
+	}
+
+	check(LineHandle >= 0 && LineHandle < NextLineHandle.load(std::memory_order_relaxed));
+	LineCommands.Enqueue(FLineCommand{ Command, LineHandle, MoveTemp(LineDescriptor) });
+
+	// Widgets can only be invalidated on the game thread, once for all the commands enqueued until it gets to it.
+	if (!bLineCommandsInvalidationPending.exchange(true))
+	{
+		AsyncTask(ENamedThreads::GameThread, [this, WeakWidget = LineCommandsWidget]()
+		{
+			// The drawer lives as long as its widget.
+			if (WeakWidget.IsValid())
+			{
+				bLineCommandsInvalidationPending = false;
+				InvalidateLineDrawer();
+			}
+		});
+	}
+}
+
+bool ILineDrawer::ApplyLineCommands()
+{
+	DrainedLineCommands.Reset();
+	while (TOptional<FLineCommand> Command = LineCommands.Dequeue())
+	{
+		DrainedLineCommands.Add(MoveTemp(Command.GetValue()));
+	}
+	if (DrainedLineCommands.Num() == 0)
+	{
+		return false;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::ApplyLineCommands);
+
+	// The commands of a producer come out in the order it enqueued them, sorting by handle keeps that order within each line.
+	LineCommandOrder.Reset();
+	for (int32 Index = 0; Index < DrainedLineCommands.Num(); ++Index)
+	{
+		LineCommandOrder.Add(Index);
+	}
+	Algo::Sort(LineCommandOrder, [this](int32 A, int32 B)
+	{
+		const int32 HandleA = DrainedLineCommands[A].LineHandle;
+		const int32 HandleB = DrainedLineCommands[B].LineHandle;
+		return HandleA != HandleB ? HandleA < HandleB : A < B;
+	});
+
+	int32 NumAppliedCommands = 0;
+	for (int32 RunBegin = 0; RunBegin < LineCommandOrder.Num();)
+	{
+		const int32 LineHandle = DrainedLineCommands[LineCommandOrder[RunBegin]].LineHandle;
+		const int32 LineIndex = GetLineOfHandle(LineHandle);
+
+		// Folded in order from the line the handle has now. Updates of a handle without a line are dropped, an add carries the
+		// descriptor. Nothing after a release belongs to the handle anymore.
+		bool bLineExists = LineIndex != INDEX_NONE;
+		bool bEraseLine = false;
+		bool bReleased = false;
+		FLineCommand* DescriptorCommand = nullptr;
+		int32 RunEnd = RunBegin;
+		for (; RunEnd < LineCommandOrder.Num() && DrainedLineCommands[LineCommandOrder[RunEnd]].LineHandle == LineHandle; ++RunEnd)
+		{
+			FLineCommand& Command = DrainedLineCommands[LineCommandOrder[RunEnd]];
+			if (bReleased)
+			{
+				continue;
+			}
+
+			switch (Command.Command)
+			{
+			case ELineCommand::Add:
+				bLineExists = true;
+				DescriptorCommand = &Command;
+				break;
+			case ELineCommand::Update:
+				DescriptorCommand = bLineExists ? &Command : DescriptorCommand;
+				break;
+			case ELineCommand::Remove:
+			case ELineCommand::Release:
+				bEraseLine |= LineIndex != INDEX_NONE;
+				bLineExists = false;
+				DescriptorCommand = nullptr;
+				bReleased = Command.Command == ELineCommand::Release;
+				break;
+			}
+		}
+		RunBegin = RunEnd;
+		++NumAppliedCommands;
+
+		if (bEraseLine)
+		{
+			EraseLine(LineIndex);
+		}
+
+		if (bReleased)
+		{
+			FreeLineHandles.Add(LineHandle);
+		}
+		else if (bLineExists && (bEraseLine || LineIndex == INDEX_NONE))
+		{
+			const int32 NewLineIndex = EmplaceLine(MoveTemp(DescriptorCommand->LineDescriptor));
+			LineDatas[NewLineIndex].LineHandle = LineHandle;
+			HandleLines.Add(LineHandle, NewLineIndex);
+		}
+		else if (bLineExists && DescriptorCommand)
+		{
+			LineDatas[LineIndex].LineDescriptor = MoveTemp(DescriptorCommand->LineDescriptor);
+			MarkLineChanged(LineIndex);
+		}
+	}
+
+	GLineDrawerFrameCounters.NumLineCommands += DrainedLineCommands.Num();
+	GLineDrawerFrameCounters.NumCoalescedLineCommands += DrainedLineCommands.Num() - NumAppliedCommands;
+	DrainedLineCommands.Reset();
+	return true;
+}
+
+void ILineDrawer::RemoveLine(int32 LineIndex)
+{
+	if (EnsureNotLineView() && EraseLine(LineIndex))
+	{
+		InvalidateLineDrawer();
+	}
+}
+
+void ILineDrawer::RemoveLines(TConstArrayView<int32> LineIndices)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::RemoveLines);
+	if (!EnsureNotLineView())
+	{
+		return;
+	}
+
+	bool bAnyLineRemoved = false;
+	for (const int32 LineIndex : LineIndices)
+	{
+		bAnyLineRemoved |= EraseLine(LineIndex);
+	}
+
+	if (bAnyLineRemoved)
+	{
+		InvalidateLineDrawer();
+	}
+}
+
+void ILineDrawer::RemoveAllLines()
+{
+	for (FLineData& LineData : LineDatas)
+	{
+		BufferPool.Release(LineData);
+	}
+	LineDatas.Empty();
+	HotStore.Reset();
+	StreamingLines.Reset();
+	HandleLines.Reset();
+	for (ILineDrawer* LineView : LineViews)
+	{
+		LineView->RemoveAllLines();
+	}
+	for (FLineShape& Shape : LineShapes)
+	{
+		Shape.Instances.Reset();
+	}
+	SpatialGrid.Reset();
+	PendingInterpCurveLines.Reset();
+	VisibleLines.Reset();
+	MaxLinePixelPadding = 0.0f;
+	bDrawBatchesDirty = true;
+	InvalidateLineDrawer();
+}
+
+bool ILineDrawer::FindLineAt(const FVector2f& LocalPosition, float Tolerance, FLineHit& OutHit) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::FindLineAt);
+
+	Tolerance = FMath::Max(Tolerance, 0.0f);
+	HitTestLines.Reset();
+	SpatialGrid.Query(FBox2f(LocalPosition, LocalPosition).ExpandBy(Tolerance), LineDatas.GetMaxIndex(), SpatialQueryVisitedLines, HitTestLines);
+
+	float BestDistanceSq = FMath::Square(Tolerance);
+	int32 BestSegment = INDEX_NONE;
+	float BestAlpha = 0.0f;
+	uint64 BestDrawOrder = 0;
+	OutHit = FLineHit();
+	for (const int32 LineIndex : HitTestLines)
+	{
+		FLineData& LineData = LineDatas[LineIndex];
+		// A view only drops the lines removed from its source on its next paint.
+		if (LineData.SampleBounds.ComputeSquaredDistanceToPoint(LocalPosition) > BestDistanceSq || (LineSource && !LineSource->LineDatas.IsValidIndex(LineIndex)))
+		{
+			continue;
+		}
+
+		// Instances are tested against the samples of their shape, moved into the widget with their transform, views against the samples of their source.
+		const FSlateRenderTransform* InstanceTransform = LineData.Instance ? &LineData.Instance->Transform : nullptr;
+		FLineData& PointsData = LineSource ? LineSource->LineDatas[LineIndex] : InstanceTransform ? LineShapes[LineData.Instance->ShapeIndex].LineData : LineData;
+		const TConstArrayView<FVector2f> Points = GetLinePoints(PointsData);
+		const TConstArrayView<FBox2f> ChunkBounds = GetSegmentChunkBounds(PointsData);
+		auto GetPoint = [&Points, InstanceTransform](int32 Index)
+		{
+			return InstanceTransform ? InstanceTransform->TransformPoint(Points[Index]) : Points[Index];
+		};
+		const uint64 DrawOrder = GetLineDrawOrder(LineData);
+		for (int32 Chunk = 0; Chunk < ChunkBounds.Num(); ++Chunk)
+		{
+			const FBox2f Bounds = InstanceTransform ? TransformBounds(ChunkBounds[Chunk], *InstanceTransform) : ChunkBounds[Chunk];
+			if (Bounds.ComputeSquaredDistanceToPoint(LocalPosition) > BestDistanceSq)
+			{
+				continue;
+			}
+
+			const int32 EndSegment = FMath::Min((Chunk + 1) * HitTestChunkSegments, Points.Num() - 1);
+			for (int32 Segment = Chunk * HitTestChunkSegments; Segment < EndSegment; ++Segment)
+			{
+				const FVector2f SegmentStart = GetPoint(Segment);
+				const FVector2f SegmentDelta = GetPoint(Segment + 1) - SegmentStart;
+				const float SegmentLengthSq = SegmentDelta.SizeSquared();
+				const float Alpha = SegmentLengthSq > SMALL_NUMBER ? FMath::Clamp(FVector2f::DotProduct(LocalPosition - SegmentStart, SegmentDelta) / SegmentLengthSq, 0.0f, 1.0f) : 0.0f;
+				const FVector2f Position = SegmentStart + SegmentDelta * Alpha;
+				const float DistanceSq = FVector2f::DistSquared(LocalPosition, Position);
+				// The line drawn later is on top. Lines that weren't drawn, or in the same place, fall back to their index.
+				const bool bOnTop = DrawOrder > BestDrawOrder || (DrawOrder == BestDrawOrder && LineIndex > OutHit.LineIndex);
+				if (DistanceSq < BestDistanceSq || (DistanceSq == BestDistanceSq && bOnTop))
+				{
+					BestDistanceSq = DistanceSq;
+					BestDrawOrder = DrawOrder;
+					BestSegment = Segment;
+					BestAlpha = Alpha;
+					OutHit.LineIndex = LineIndex;
+					OutHit.Position = Position;
+				}
+			}
+		}
+	}
+
+	if (OutHit.LineIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const FLineData& HitLineData = LineDatas[OutHit.LineIndex];
+	OutHit.Distance = FMath::Sqrt(BestDistanceSq);
+	OutHit.T = GetLineHitT(LineSource ? LineSource->LineDatas[OutHit.LineIndex] : HitLineData.Instance ? LineShapes[HitLineData.Instance->ShapeIndex].LineData : HitLineData, BestSegment, BestAlpha);
+	return true;
+}
+
+TArray<int32> ILineDrawer::FindLinesInRect(const FBox2f& LocalRect) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::FindLinesInRect);
+
+	HitTestLines.Reset();
+	SpatialGrid.Query(LocalRect, LineDatas.GetMaxIndex(), SpatialQueryVisitedLines, HitTestLines);
+
+	TArray<int32> LineIndices;
+	for (const int32 LineIndex : HitTestLines)
+	{
+		FLineData& LineData = LineDatas[LineIndex];
+		// A view only drops the lines removed from its source on its next paint.
+		if (!LineData.SampleBounds.Intersect(LocalRect) || (LineSource && !LineSource->LineDatas.IsValidIndex(LineIndex)))
+		{
+			continue;
+		}
+
+		const FSlateRenderTransform* InstanceTransform = LineData.Instance ? &LineData.Instance->Transform : nullptr;
+		FLineData& PointsData = LineSource ? LineSource->LineDatas[LineIndex] : InstanceTransform ? LineShapes[LineData.Instance->ShapeIndex].LineData : LineData;
+		const TConstArrayView<FVector2f> Points = GetLinePoints(PointsData);
+		if (Points.Num() > 0 && LocalRect.IsInside(LineData.SampleBounds))
+		{
+			LineIndices.Add(LineIndex);
+			continue;
+		}
+
+		auto GetPoint = [&Points, InstanceTransform](int32 Index)
+		{
+			return InstanceTransform ? InstanceTransform->TransformPoint(Points[Index]) : Points[Index];
+		};
+		const TConstArrayView<FBox2f> ChunkBounds = GetSegmentChunkBounds(PointsData);
+		bool bInside = Points.Num() == 1 && LocalRect.IsInsideOrOn(GetPoint(0));
+		for (int32 Chunk = 0; Chunk < ChunkBounds.Num() && !bInside; ++Chunk)
+		{
+			if (!(InstanceTransform ? TransformBounds(ChunkBounds[Chunk], *InstanceTransform) : ChunkBounds[Chunk]).Intersect(LocalRect))
+			{
+				continue;
+			}
+
+			const int32 EndSegment = FMath::Min((Chunk + 1) * HitTestChunkSegments, Points.Num() - 1);
+			for (int32 Segment = Chunk * HitTestChunkSegments; Segment < EndSegment && !bInside; ++Segment)
+			{
+				bInside = SegmentIntersectsBox(GetPoint(Segment), GetPoint(Segment + 1), LocalRect);
+			}
+		}
+
+		if (bInside)
+		{
+			LineIndices.Add(LineIndex);
+		}
+	}
+
+	Algo::Sort(LineIndices);
+	return LineIndices;
+}
+
+TArray<int32> ILineDrawer::GetAllLines() const
+{
+	TArray<int32> Indexes;
+	Indexes.Reserve(LineDatas.Num());
+	for (auto It = LineDatas.CreateConstIterator(); It; ++It)
+	{
+		Indexes.Add(It.GetIndex());
+	}
+
+	return Indexes;
+}
+
+const FLineDescriptor* ILineDrawer::GetLine(int32 LineIndex)
+{
+	if (!LineDatas.IsValidIndex(LineIndex))
+	{
+		return nullptr;
+	}
+
+	return &LineDatas[LineIndex].LineDescriptor;
+}
+
+TConstArrayView<FVector2f> ILineDrawer::GetLinePoints(int32 LineIndex) const
+{
+	if (!LineDatas.IsValidIndex(LineIndex))
+	{
+		return TConstArrayView<FVector2f>();
+	}
+
+	const FLineData& LineData = LineDatas[LineIndex];
+	if (LineSource)
+	{
+		return LineSource->LineDatas.IsValidIndex(LineIndex) ? GetLinePoints(LineSource->LineDatas[LineIndex]) : TConstArrayView<FVector2f>();
+	}
+	return GetLinePoints(LineData.Instance ? LineShapes[LineData.Instance->ShapeIndex].LineData : LineData);
+}
+
+UMaterialInstanceDynamic* ILineDrawer::GetOrCreateMaterialInstanceOfLine(int32 LineIndex)
+{
+	if (!EnsureNotLineView() || !LineDatas.IsValidIndex(LineIndex))
+	{
+		return nullptr;
+	}
+
+	FLineData& LineData = LineDatas[LineIndex];
+	UObject* ResourceObject = LineData.LineDescriptor.Brush.GetResourceObject();
+	if (!ResourceObject)
+	{
+		return nullptr;
+	}
+
+	UMaterialInterface* Material = Cast<UMaterialInterface>(ResourceObject);
+	if (!Material)
+	{
+		return nullptr;
+	}
+
+	if (UMaterialInstanceDynamic* ExistingMID = Cast<UMaterialInstanceDynamic>(Material))
+	{
+		return ExistingMID;
+	}
+
+	UMaterialInstanceDynamic* NewMID = UMaterialInstanceDynamic::Create(Material, nullptr);
+	LineData.LineDescriptor.Brush.SetResourceObject(NewMID);
+	LineData.RenderData.RenderingResourceHandle = FSlateApplication::Get().GetRenderer()->GetResourceHandle(LineData.LineDescriptor.Brush);
+	LineData.RenderData.ResourceObject = NewMID;
+	LineData.RenderData.ResourceName = LineData.LineDescriptor.Brush.GetResourceName();
+	LineData.RenderData.bHasDynamicMaterial = true;
+	NotifyLineViews(LineIndex);
+	bDrawBatchesDirty = true;
+	return NewMID;
+}
+
+void ILineDrawer::ReserveLines(int32 NumLinesToAdd)
+{
+	LineDatas.Reserve(LineDatas.Num() + NumLinesToAdd);
+	PendingInterpCurveLines.Reserve(PendingInterpCurveLines.Num() + NumLinesToAdd);
+}
+
+int32 ILineDrawer::EmplaceLine(FLineDescriptor&& LineDescriptor)
+{
+	FLineData NewLineData;
+	NewLineData.LineDescriptor = MoveTemp(LineDescriptor);
+	NewLineData.bNeedReEvalInterpCurve = true;
+	NewLineData.Serial = ++NextLineSerial;
+	NewLineData.StaleSinceFrame = GFrameCounter;
+	// Assumes a few samples per key, like EstimateLineCost.
+	BufferPool.Acquire(NewLineData, NewLineData.LineDescriptor.InterpCurve.Points.Num() * 4);
+
+	const int32 LineIndex = LineDatas.Emplace(MoveTemp(NewLineData));
+	HotStore.Add(LineIndex);
+	PendingInterpCurveLines.Add(LineIndex);
+	bDrawBatchesDirty = true;
+	return LineIndex;
+}
+
+void ILineDrawer::MarkLineDirty(int32 LineIndex)
+{
+	FLineData& LineData = LineDatas[LineIndex];
+	if (!LineData.bNeedReEvalInterpCurve)
+	{
+		LineData.bNeedReEvalInterpCurve = true;
+		PendingInterpCurveLines.Add(LineIndex);
+	}
+	++LineData.DataGeneration;
+	HotStore.MarkRenderDataStale(LineIndex);
+	if (LineData.StaleSinceFrame == MAX_uint64)
+	{
+		LineData.StaleSinceFrame = GFrameCounter;
+	}
+	LineData.RenderData.RenderingResourceHandle = FSlateResourceHandle();
+	bDrawBatchesDirty = true;
+}
+
+void ILineDrawer::MarkLineChanged(int32 LineIndex)
+{
+	FLineData& LineData = LineDatas[LineIndex];
+	FLineDescriptor& LineDescriptor = LineData.LineDescriptor;
+	// The curve and thickness of an instance are those of its shape, only its brush is its own.
+	if (!LineData.Instance && (LineData.bNeedReEvalInterpCurve || !IsCurveSampled(LineData)))
+	{
+		UpdateDirtyKeyRange(LineData);
+		MarkLineDirty(LineIndex);
+		return;
+	}
+
+	++LineData.DataGeneration;
+	HotStore.MarkRenderDataStale(LineIndex);
+	NotifyLineViews(LineIndex);
+
+	FRenderData& RenderData = LineData.RenderData;
+	if (RenderData.RenderingResourceHandle.IsValid() && (RenderData.ResourceObject != LineDescriptor.Brush.GetResourceObject() || RenderData.ResourceName != LineDescriptor.Brush.GetResourceName()))
+	{
+		RenderData.RenderingResourceHandle = FSlateResourceHandle();
+		bDrawBatchesDirty = true;
+	}
+
+	if (LineData.LocalGeometryDrawScale > 0.0f && (LineDescriptor.Thickness != LineData.GeometryThickness || !IsSameDecimation(LineData, LineDescriptor)))
+	{
+		// Lines only re-enter the spatial grid after a curve change, so widen the culling padding now.
+		const float PixelPadding = GetLinePixelPadding(LineDescriptor);
+		HotStore.PixelPaddings[HotStore.LineSlots[LineIndex]] = PixelPadding;
+		MaxLinePixelPadding = FMath::Max(MaxLinePixelPadding, PixelPadding);
+		LineData.bNeedRebuildLocalGeometry = true;
+		PendingInterpCurveLines.Add(LineIndex);
+		bDrawBatchesDirty = true;
+	}
+	else if (!LineData.bNeedRebuildLocalGeometry && !LineData.bTessellationInFlight)
+	{
+		PatchLineVertexColor(LineData);
+	}
+}
+
+void ILineDrawer::PatchLineVertexColor(FLineData& InOutLineData) const
+{
+	FRenderData& RenderData = InOutLineData.RenderData;
+	const FColor VertexColor = GetLineVertexColor(InOutLineData.LineDescriptor);
+	if (VertexColor == RenderData.VertexColor)
+	{
+		return;
+	}
+
+	RenderData.VertexColor = VertexColor;
+	for (FSlateVertex& Vertex : RenderData.VertexData)
+	{
+		Vertex.Color = VertexColor;
+	}
+
+	// Patch the copy in the merged batch as well, so a highlight doesn't have to rebuild the batches.
+	if (!bDrawBatchesDirty && RenderData.DrawBatchesVersion == DrawBatchesVersion && DrawBatches.IsValidIndex(RenderData.DrawBatchIndex))
+	{
+		FSlateVertex* BatchVertices = DrawBatches[RenderData.DrawBatchIndex].VertexData.GetData() + RenderData.DrawBatchFirstVertex;
+		for (int32 Index = 0; Index < RenderData.VertexData.Num(); ++Index)
+		{
+			BatchVertices[Index].Color = VertexColor;
+		}
+	}
+}
+
+FColor ILineDrawer::GetLineVertexColor(const FLineDescriptor& LineDescriptor)
+{
+	return LineDescriptor.Brush.TintColor.GetSpecifiedColor().ToFColor(true);
+}
+
+static bool IsSameCurveKey(const FInterpCurvePoint<FVector2f>& Key, const FInterpCurvePoint<FVector2f>& OtherKey)
+{
+	return Key.InVal == OtherKey.InVal && Key.OutVal == OtherKey.OutVal && Key.ArriveTangent == OtherKey.ArriveTangent && Key.LeaveTangent == OtherKey.LeaveTangent
+		&& Key.InterpMode == OtherKey.InterpMode;
+}
+
+void ILineDrawer::UpdateDirtyKeyRange(FLineData& InOutLineData)
+{
+	// The range is redone from the sampled keys on every change, so it covers all the edits made since the last evaluation.
+	const TArray<FInterpCurvePoint<FVector2f>>& Keys = InOutLineData.LineDescriptor.InterpCurve.Points;
+	const TArray<FInterpCurvePoint<FVector2f>>& SampledKeys = InOutLineData.SampledKeys;
+	InOutLineData.DirtyKeyBegin = InOutLineData.DirtyKeyEnd = INDEX_NONE;
+	if (Keys.Num() != SampledKeys.Num() || !InOutLineData.SampledCurveSettings.Matches(InOutLineData.LineDescriptor))
+	{
+		return;
+	}
+
+	for (int32 Index = 0; Index < Keys.Num(); ++Index)
+	{
+		if (IsSameCurveKey(Keys[Index], SampledKeys[Index]))
+		{
+			continue;
+		}
+
+		// Moving a key along T can move the sampled range and the first sampled key, only the whole curve is re-sampled then.
+		if (Keys[Index].InVal != SampledKeys[Index].InVal)
+		{
+			InOutLineData.DirtyKeyBegin = InOutLineData.DirtyKeyEnd = INDEX_NONE;
+			return;
+		}
+		InOutLineData.DirtyKeyBegin = InOutLineData.DirtyKeyBegin == INDEX_NONE ? Index : InOutLineData.DirtyKeyBegin;
+		InOutLineData.DirtyKeyEnd = Index;
+	}
+}
+
+bool ILineDrawer::IsCurveSampled(const FLineData& LineData)
+{
+	const TArray<FInterpCurvePoint<FVector2f>>& Keys = LineData.LineDescriptor.InterpCurve.Points;
+	const TArray<FInterpCurvePoint<FVector2f>>& SampledKeys = LineData.SampledKeys;
+	if (Keys.Num() != SampledKeys.Num() || !LineData.SampledCurveSettings.Matches(LineData.LineDescriptor))
+	{
+		return false;
+	}
+
+	for (int32 Index = 0; Index < Keys.Num(); ++Index)
+	{
+		if (!IsSameCurveKey(Keys[Index], SampledKeys[Index]))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void ILineDrawer::SetSampledCurve(FLineData& InOutLineData)
+{
+	InOutLineData.SampledKeys = InOutLineData.LineDescriptor.InterpCurve.Points;
+	InOutLineData.SampledCurveSettings.Set(InOutLineData.LineDescriptor);
+}
+
+void ILineDrawer::FSampledCurveSettings::Set(const FLineDescriptor& LineDescriptor)
+{
+	PolylinePoints = LineDescriptor.PolylinePoints;
+	InterpCurveStartT = LineDescriptor.InterpCurveStartT;
+	InterpCurveEndT = LineDescriptor.InterpCurveEndT;
+	Resolution = LineDescriptor.Resolution;
+	DynamicResolutionFactor = LineDescriptor.DynamicResolutionFactor;
+	MaxResolution = LineDescriptor.MaxResolution;
+	TessellationTolerance = LineDescriptor.TessellationTolerance;
+	TessellationMode = LineDescriptor.TessellationMode;
+	LoopKeyOffset = LineDescriptor.InterpCurve.LoopKeyOffset;
+	bIsLooped = LineDescriptor.InterpCurve.bIsLooped;
+}
+
+bool ILineDrawer::FSampledCurveSettings::Matches(const FLineDescriptor& LineDescriptor) const
+{
+	return InterpCurveStartT == LineDescriptor.InterpCurveStartT && InterpCurveEndT == LineDescriptor.InterpCurveEndT && Resolution == LineDescriptor.Resolution
+		&& DynamicResolutionFactor == LineDescriptor.DynamicResolutionFactor && MaxResolution == LineDescriptor.MaxResolution
+		&& TessellationTolerance == LineDescriptor.TessellationTolerance && TessellationMode == LineDescriptor.TessellationMode
+		&& bIsLooped == LineDescriptor.InterpCurve.bIsLooped && LoopKeyOffset == LineDescriptor.InterpCurve.LoopKeyOffset
+		&& PolylinePoints.Pin() == LineDescriptor.PolylinePoints;
+}
+
+bool ILineDrawer::EraseLine(int32 LineIndex)
+{
+	if (!LineDatas.IsValidIndex(LineIndex))
+	{
+		return false;
+	}
+
+	SpatialGrid.RemoveLine(LineIndex, LineDatas[LineIndex]);
+	BufferPool.Release(LineDatas[LineIndex]);
+	HotStore.Remove(LineIndex);
+	if (LineDatas[LineIndex].Streaming)
+	{
+		StreamingLines.RemoveSingleSwap(LineIndex, EAllowShrinking::No);
+	}
+	if (const FLineInstance* Instance = LineDatas[LineIndex].Instance.Get())
+	{
+		LineShapes[Instance->ShapeIndex].Instances.RemoveSingleSwap(LineIndex, EAllowShrinking::No);
+	}
+	if (LineDatas[LineIndex].LineHandle != INDEX_NONE)
+	{
+		HandleLines.Remove(LineDatas[LineIndex].LineHandle);
+	}
+	LineDatas.RemoveAt(LineIndex);
+	// The views drop their geometry of the line now, so a line added later at the same index is never mistaken for it.
+	for (ILineDrawer* LineView : LineViews)
+	{
+		LineView->EraseLine(LineIndex);
+	}
+	NotifyLineViews(LineIndex);
+	bDrawBatchesDirty = true;
+	return true;
+}
+
+bool ILineDrawer::EnsureNotLineView() const
+{
+	return ensureMsgf(!LineSource, TEXT("The lines of a view are added and edited through its source"));
+}
+
+void ILineDrawer::InvalidateLineDrawer()
+{
+	GetLineDrawerWidget().Invalidate(EInvalidateWidgetReason::Paint);
+	for (ILineDrawer* LineView : LineViews)
+	{
+		LineView->GetLineDrawerWidget().Invalidate(EInvalidateWidgetReason::Paint);
+	}
+}
+
+void ILineDrawer::NotifyLineViews(int32 LineIndex) const
+{
+	for (ILineDrawer* LineView : LineViews)
+	{
+		TBitArray<>& PendingLines = LineView->PendingSourceLines;
+		if (LineIndex >= PendingLines.Num())
+		{
+			PendingLines.Add(false, LineIndex + 1 - PendingLines.Num());
+		}
+		PendingLines[LineIndex] = true;
+	}
+}
+
+void ILineDrawer::CopyLineStyle(const FLineDescriptor& SourceDescriptor, FLineDescriptor& OutLineDescriptor)
+{
+	// What building the geometry reads from the descriptor besides the points.
+	OutLineDescriptor.Thickness = SourceDescriptor.Thickness;
+	OutLineDescriptor.Decimation = SourceDescriptor.Decimation;
+	OutLineDescriptor.DecimationTolerance = SourceDescriptor.DecimationTolerance;
+	OutLineDescriptor.Brush = SourceDescriptor.Brush;
+}
+
+void ILineDrawer::AddLineDrawerReferencedObjects(FReferenceCollector& Collector) const
+{
+	for (FLineData& LineData : LineDatas)
+	{
+		LineData.LineDescriptor.Brush.AddReferencedObjects(Collector);
+	}
+	for (FLineShape& Shape : LineShapes)
+	{
+		Shape.LineData.LineDescriptor.Brush.AddReferencedObjects(Collector);
+	}
+}
+
+int32 ILineDrawer::DrawLines(const FGeometry& AllottedGeometry, const FSlateRect& CullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId) const
+{
+	DECLARE_SCOPE_CYCLE_COUNTER(TEXT("DrawLines"), STAT_LineDrawer_DrawLines, STATGROUP_LineDrawer);
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::DrawLines);
+	LLM_SCOPE_BYTAG(LineDrawer);
+
+	const FPaintGeometry PaintGeometry = AllottedGeometry.ToPaintGeometry();
+	const FSlateRenderTransform& RenderTransform = PaintGeometry.GetAccumulatedRenderTransform();
+	const float DrawScale = PaintGeometry.DrawScale;
+
+	LastAllottedGeometry = AllottedGeometry;
+	LastDrawScale = DrawScale;
+	// DrawLines is const because OnPaint is, the commands are applied before anything reads the lines.
+	const_cast<ILineDrawer*>(this)->ApplyLineCommands();
+	UpdateFromLineSource();
+	UpdateStreamingLines(AllottedGeometry, RenderTransform, DrawScale);
+	UpdateLineShapes(AllottedGeometry, DrawScale);
+	// Views only build geometry from the samples of their source, which is fast enough to do in place.
+	const bool bAsyncTessellation = GLineDrawerAsyncTessellation && !LineSource;
+	if (bAsyncTessellation)
+	{
+		ApplyFinishedTessellationJobs(RenderTransform, false);
+	}
+	else
+	{
+		ApplyFinishedTessellationJobs(RenderTransform, true);
+		EvalPendingLineInterpCurves(AllottedGeometry, DrawScale);
+	}
+	const bool bVisibleLinesChanged = GatherVisibleLines(CullingRect, RenderTransform, DrawScale);
+
+	if (HotStore.RenderTransform != RenderTransform || HotStore.DrawScale != DrawScale)
+	{
+		HotStore.RenderTransform = RenderTransform;
+		HotStore.DrawScale = DrawScale;
+		FMemory::Memzero(HotStore.RenderDataCurrent.GetData(), HotStore.RenderDataCurrent.Num() * sizeof(bool));
+	}
+
+	// On a frame where nothing moved, this only reads the dense flags of the visible lines.
+	LineWorkItems.Reset();
+	for (const int32 LineIndex : VisibleLines)
+	{
+		bool& bRenderDataCurrent = HotStore.RenderDataCurrent[HotStore.LineSlots[LineIndex]];
+		if (bRenderDataCurrent)
+		{
+			continue;
+		}
+
+		const FLineData& LineData = LineDatas[LineIndex];
+		if (!IsRenderDataUpToDate(LineData, RenderTransform, DrawScale))
+		{
+			const bool bNeedRebuild = !bAsyncTessellation && (LineData.bNeedRebuildLocalGeometry || NeedRebuildLocalGeometry(LineData, DrawScale));
+			LineWorkItems.Add({ LineIndex, EstimateLineCost(LineData, !bAsyncTessellation && NeedReEvalForDrawScale(LineData, DrawScale), bNeedRebuild) });
+		}
+		else
+		{
+			bRenderDataCurrent = true;
+		}
+	}
+
+	std::atomic<int32> NumTransformedLines = 0;
+	std::atomic<int32> NumRebuiltLines = 0;
+	ParallelForLines(TEXT("ILineDrawer::ParallelUpdateLineRenderData"), LineWorkItems, [this, &AllottedGeometry, &RenderTransform, DrawScale, bAsyncTessellation, &NumTransformedLines, &NumRebuiltLines](int32 LineIndex)
+	{
+		FLineData& LineData = LineDatas[LineIndex];
+		const ERenderDataUpdate Update = LineSource ? UpdateMirroredLineRenderData(LineIndex, LineData, RenderTransform, DrawScale)
+			: LineData.Instance ? UpdateLineInstanceRenderData(LineData, RenderTransform)
+			: UpdateLineRenderData(LineData, AllottedGeometry, RenderTransform, DrawScale, bAsyncTessellation && !LineData.Streaming);
+		if (Update == ERenderDataUpdate::Transformed)
+		{
+			NumTransformedLines.fetch_add(1, std::memory_order_relaxed);
+		}
+		else if (Update == ERenderDataUpdate::Rebuilt)
+		{
+			NumRebuiltLines.fetch_add(1, std::memory_order_relaxed);
+		}
+	});
+
+	if (NumRebuiltLines.load(std::memory_order_relaxed) > 0)
+	{
+		for (const int32 LineIndex : VisibleLines)
+		{
+			UpdateLineSpatialGrid(LineIndex);
+		}
+	}
+
+	if (bAsyncTessellation)
+	{
+		// Visible lines whose geometry no longer matches the DrawScale were flagged by the update pass.
+		for (const int32 LineIndex : VisibleLines)
+		{
+			if (LineDatas[LineIndex].bNeedRebuildLocalGeometry && !LineDatas[LineIndex].bTessellationInFlight)
+			{
+				PendingInterpCurveLines.Add(LineIndex);
+			}
+		}
+		KickTessellationJobs();
+	}
+
+	const int32 NumCacheMisses = NumTransformedLines.load(std::memory_order_relaxed) + NumRebuiltLines.load(std::memory_order_relaxed);
+	const int32 NumCacheHits = VisibleLines.Num() - NumCacheMisses;
+	INC_DWORD_STAT_BY(STAT_LineDrawer_RenderDataCacheHits, NumCacheHits);
+	INC_DWORD_STAT_BY(STAT_LineDrawer_RenderDataCacheMisses, NumCacheMisses);
+	INC_DWORD_STAT_BY(STAT_LineDrawer_TransformOnlyUpdates, NumTransformedLines.load(std::memory_order_relaxed));
+	SET_FLOAT_STAT(STAT_LineDrawer_RenderDataCacheHitRate, VisibleLines.Num() > 0 ? static_cast<float>(NumCacheHits) / VisibleLines.Num() : 1.0f);
+	INC_DWORD_STAT_BY(STAT_LineDrawer_VisibleLines, VisibleLines.Num());
+	INC_DWORD_STAT_BY(STAT_LineDrawer_CulledLines, LineDatas.Num() - VisibleLines.Num());
+	PublishFrameCounters();
+	UpdateTessellationStats();
+
+	if (bDrawBatchesDirty || bVisibleLinesChanged || NumCacheMisses > 0)
+	{
+		RebuildDrawBatches();
+	}
+
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::DrawLines::DrawElements);
+		int32 NumVertices = 0;
+		int32 NumIndices = 0;
+		int32 NumDrawElements = DrawBatches.Num();
+		for (const FDrawBatch& DrawBatch : DrawBatches)
+		{
+			FSlateDrawElement::MakeCustomVerts(OutDrawElements, LayerId, DrawBatch.RenderingResourceHandle, DrawBatch.VertexData, DrawBatch.IndexData, nullptr, 0, 0);
+			NumVertices += DrawBatch.VertexData.Num();
+			NumIndices += DrawBatch.IndexData.Num();
+		}
+		// Appends since the batches were built are in the render data already, whether the batches were rebuilt or not.
+		for (const int32 LineIndex : VisibleStreamingLines)
+		{
+			const FRenderData& RenderData = LineDatas[LineIndex].RenderData;
+			if (RenderData.IndexData.Num() == 0)
+			{
+				continue;
+			}
+			FSlateDrawElement::MakeCustomVerts(OutDrawElements, LayerId, RenderData.RenderingResourceHandle, RenderData.VertexData, RenderData.IndexData, nullptr, 0, 0);
+			NumVertices += RenderData.VertexData.Num();
+			NumIndices += RenderData.IndexData.Num();
+			++NumDrawElements;
+		}
+		NumDrawnVertices = NumVertices;
+		INC_DWORD_STAT_BY(STAT_LineDrawer_DrawElements, NumDrawElements);
+		INC_DWORD_STAT_BY(STAT_LineDrawer_Vertices, NumVertices);
+		INC_DWORD_STAT_BY(STAT_LineDrawer_Indices, NumIndices);
+		GLineDrawerFrameCounters.NumVertices += NumVertices;
+		GLineDrawerFrameCounters.NumIndices += NumIndices;
+		GLineDrawerFrameCounters.NumDrawElements += NumDrawElements;
+	}
+
+	RequestLineViewsRepaint();
+	return LayerId;
+}
+
+void ILineDrawer::EvalPendingLineInterpCurves(const FGeometry& AllottedGeometry, float DrawScale) const
+{
+	if (PendingInterpCurveLines.Num() == 0)
+	{
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::EvalPendingLineInterpCurves);
+
+	Algo::Sort(PendingInterpCurveLines);
+	PendingInterpCurveLines.SetNum(Algo::Unique(PendingInterpCurveLines));
+	PendingInterpCurveLines.RemoveAll([this](int32 LineIndex)
+	{
+		return !LineDatas.IsValidIndex(LineIndex) || !LineDatas[LineIndex].bNeedReEvalInterpCurve;
+	});
+
+	LineWorkItems.Reset();
+	for (const int32 LineIndex : PendingInterpCurveLines)
+	{
+		LineWorkItems.Add({ LineIndex, EstimateLineCost(LineDatas[LineIndex], true, false) });
+	}
+
+	ParallelForLines(TEXT("ILineDrawer::ParallelEvalLineInterpCurve"), LineWorkItems, [this, &AllottedGeometry, DrawScale](int32 LineIndex)
+	{
+		FLineData& LineData = LineDatas[LineIndex];
+		if (!ReEvalDirtyKeyIntervals(LineData, AllottedGeometry, DrawScale))
+		{
+			EvalLineInterpCurve(LineData, AllottedGeometry, DrawScale);
+		}
+	});
+
+	for (const int32 LineIndex : PendingInterpCurveLines)
+	{
+		UpdateLineSpatialGrid(LineIndex);
+		HotStore.MarkRenderDataStale(LineIndex);
+		LineDatas[LineIndex].StaleSinceFrame = MAX_uint64;
+	}
+	PendingInterpCurveLines.Reset();
+}
+
+void ILineDrawer::KickTessellationJobs() const
+{
+	if (!GLineDrawerAsyncTessellation || PendingInterpCurveLines.Num() == 0 || LastDrawScale <= 0.0f)
+	{
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::KickTessellationJobs);
+
+	Algo::Sort(PendingInterpCurveLines);
+	PendingInterpCurveLines.SetNum(Algo::Unique(PendingInterpCurveLines));
+
+	TSharedRef<FTessellationJob> Job = MakeShared<FTessellationJob>();
+	PendingInterpCurveLines.RemoveAll([this, &Job](int32 LineIndex)
+	{
+		if (!LineDatas.IsValidIndex(LineIndex))
+		{
+			return true;
+		}
+
+		// Streaming lines only build what was appended, on the game thread in UpdateStreamingLines. Instances only copy their shape.
+		FLineData& LineData = LineDatas[LineIndex];
+		if ((!LineData.bNeedReEvalInterpCurve && !LineData.bNeedRebuildLocalGeometry) || LineData.Streaming || LineData.Instance)
+		{
+			return true;
+		}
+
+		// A line is only ever in one job so the job can keep building on the samples of the previous one. It stays pending until then.
+		if (LineData.bTessellationInFlight)
+		{
+			return false;
+		}
+
+		Job->LineIndices.Add(LineIndex);
+		Job->LineSerials.Add(LineData.Serial);
+		Job->LineGenerations.Add(LineData.DataGeneration);
+		FLineData& Snapshot = Job->LineSnapshots.AddDefaulted_GetRef();
+		BufferPool.Acquire(Snapshot, LineData.InterpCurveSamplePoints.Num());
+		Snapshot.LineDescriptor = LineData.LineDescriptor;
+		Snapshot.bNeedReEvalInterpCurve = LineData.bNeedReEvalInterpCurve;
+		Snapshot.SampleDrawScale = LineData.SampleDrawScale;
+		Snapshot.FirstSampledKey = LineData.FirstSampledKey;
+		Snapshot.LineLength = LineData.LineLength;
+		Snapshot.SampleBounds = LineData.SampleBounds;
+		// Painting only needs the bounds and the render data while the line is in flight, the samples come back with the result.
+		Swap(Snapshot.InterpCurveSamplePoints, LineData.InterpCurveSamplePoints);
+		Swap(Snapshot.IntervalSampleOffsets, LineData.IntervalSampleOffsets);
+		Swap(Snapshot.DecimatedPoints, LineData.DecimatedPoints);
+		// The job re-samples from the keys it was sampled from, the line already diffs later changes against the keys of the job.
+		Snapshot.SampledKeys = MoveTemp(LineData.SampledKeys);
+		Snapshot.SampledCurveSettings = LineData.SampledCurveSettings;
+		SetSampledCurve(LineData);
+		Snapshot.DirtyKeyBegin = LineData.DirtyKeyBegin;
+		Snapshot.DirtyKeyEnd = LineData.DirtyKeyEnd;
+		LineData.SegmentChunkBounds.Reset();
+		Snapshot.DecimationDrawScale = LineData.DecimationDrawScale;
+		Snapshot.Decimation = LineData.Decimation;
+		Snapshot.DecimationTolerance = LineData.DecimationTolerance;
+
+		LineData.DirtyKeyBegin = LineData.DirtyKeyEnd = INDEX_NONE;
+		LineData.bNeedReEvalInterpCurve = false;
+		LineData.bNeedRebuildLocalGeometry = false;
+		LineData.bTessellationInFlight = true;
+		return true;
+	});
+
+	if (Job->LineSnapshots.Num() == 0)
+	{
+		return;
+	}
+
+	// DrawLines is const because OnPaint is, the widgets are only used to request a repaint once the job is done.
+	TArray<TWeakPtr<SWidget>, TInlineAllocator<2>> WeakWidgets;
+	WeakWidgets.Add(const_cast<ILineDrawer*>(this)->GetLineDrawerWidget().AsShared());
+	for (ILineDrawer* LineView : LineViews)
+	{
+		WeakWidgets.Add(LineView->GetLineDrawerWidget().AsShared());
+	}
+	Job->Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Job, AllottedGeometry = LastAllottedGeometry, DrawScale = LastDrawScale, WeakWidgets = MoveTemp(WeakWidgets)]()
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::TessellationJob);
+		LLM_SCOPE_BYTAG(LineDrawer);
+
+		TArray<FLineWorkItem> WorkItems;
+		WorkItems.Reserve(Job->LineSnapshots.Num());
+		for (int32 Index = 0; Index < Job->LineSnapshots.Num(); ++Index)
+		{
+			WorkItems.Add({ Index, EstimateLineCost(Job->LineSnapshots[Index], Job->LineSnapshots[Index].bNeedReEvalInterpCurve, true) });
+		}
+
+		ParallelForLines(TEXT("ILineDrawer::ParallelTessellateLine"), WorkItems, [&Job, &AllottedGeometry, DrawScale](int32 Index)
+		{
+			TessellateLine(Job->LineSnapshots[Index], AllottedGeometry, DrawScale);
+		});
+
+		AsyncTask(ENamedThreads::GameThread, [WeakWidgets]()
+		{
+			for (const TWeakPtr<SWidget>& WeakWidget : WeakWidgets)
+			{
+				if (TSharedPtr<SWidget> Widget = WeakWidget.Pin())
+				{
+					Widget->Invalidate(EInvalidateWidgetReason::Paint);
+				}
+			}
+		});
+	});
+	TessellationJobs.Add(Job);
+}
+
+void ILineDrawer::ApplyFinishedTessellationJobs(const FSlateRenderTransform& RenderTransform, bool bWaitForAll) const
+{
+	if (TessellationJobs.Num() == 0)
+	{
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::ApplyFinishedTessellationJobs);
+
+	for (int32 JobIndex = 0; JobIndex < TessellationJobs.Num();)
+	{
+		FTessellationJob& Job = *TessellationJobs[JobIndex];
+		if (!Job.Task.IsCompleted())
+		{
+			if (!bWaitForAll)
+			{
+				++JobIndex;
+				continue;
+			}
+			Job.Task.Wait();
+		}
+
+		for (int32 Index = 0; Index < Job.LineIndices.Num(); ++Index)
+		{
+			const int32 LineIndex = Job.LineIndices[Index];
+			FLineData& Snapshot = Job.LineSnapshots[Index];
+			if (!LineDatas.IsValidIndex(LineIndex) || LineDatas[LineIndex].Serial != Job.LineSerials[Index])
+			{
+				BufferPool.Release(Snapshot);
+				continue;
+			}
+
+			// The buffers swapped out go back to the pool for the next job.
+			FLineData& LineData = LineDatas[LineIndex];
+			Swap(LineData.InterpCurveSamplePoints, Snapshot.InterpCurveSamplePoints);
+			Swap(LineData.IntervalSampleOffsets, Snapshot.IntervalSampleOffsets);
+			LineData.FirstSampledKey = Snapshot.FirstSampledKey;
+			LineData.SampledCurveSettings.DynamicResolutionScale = Snapshot.SampledCurveSettings.DynamicResolutionScale;
+			LineData.SampledCurveSettings.LocalTolerance = Snapshot.SampledCurveSettings.LocalTolerance;
+			LineData.LineLength = Snapshot.LineLength;
+			LineData.SampleBounds = Snapshot.SampleBounds;
+			LineData.SampleDrawScale = Snapshot.SampleDrawScale;
+			LineData.LocalGeometryDrawScale = Snapshot.LocalGeometryDrawScale;
+			LineData.GeometryThickness = Snapshot.GeometryThickness;
+			Swap(LineData.DecimatedPoints, Snapshot.DecimatedPoints);
+			LineData.SegmentChunkBounds.Reset();
+			LineData.DecimationDrawScale = Snapshot.DecimationDrawScale;
+			LineData.Decimation = Snapshot.Decimation;
+			LineData.DecimationTolerance = Snapshot.DecimationTolerance;
+			LineData.RenderData.VertexColor = Snapshot.RenderData.VertexColor;
+			Swap(LineData.RenderData.LocalPositionX, Snapshot.RenderData.LocalPositionX);
+			Swap(LineData.RenderData.LocalPositionY, Snapshot.RenderData.LocalPositionY);
+			Swap(LineData.RenderData.VertexData, Snapshot.RenderData.VertexData);
+			Swap(LineData.RenderData.IndexData, Snapshot.RenderData.IndexData);
+			BufferPool.Release(Snapshot);
+			TransformRenderData(LineData.RenderData, RenderTransform, ESlateVertexRounding::Enabled);
+			LineData.RenderDataTransform = RenderTransform;
+			LineData.bTessellationInFlight = false;
+			HotStore.MarkRenderDataStale(LineIndex);
+			if (!LineData.bNeedRebuildLocalGeometry)
+			{
+				// Picks up color changes made while the line was in flight.
+				PatchLineVertexColor(LineData);
+			}
+			LineData.bNeedUpdateSpatialGrid = true;
+			UpdateLineSpatialGrid(LineIndex);
+
+			// Edits made while the line was in flight keep it stale, they are already pending for the next job.
+			if (LineData.DataGeneration == Job.LineGenerations[Index])
+			{
+				LineData.StaleSinceFrame = MAX_uint64;
+			}
+			bDrawBatchesDirty = true;
+		}
+		TessellationJobs.RemoveAtSwap(JobIndex, 1, EAllowShrinking::No);
+	}
+}
+
+void ILineDrawer::UpdateStreamingLines(const FGeometry& AllottedGeometry, const FSlateRenderTransform& RenderTransform, float DrawScale) const
+{
+	if (StreamingLines.Num() == 0)
+	{
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::UpdateStreamingLines);
+
+	for (const int32 LineIndex : StreamingLines)
+	{
+		FLineData& LineData = LineDatas[LineIndex];
+		const FStreamingLine& Stream = *LineData.Streaming;
+		if (LineData.bNeedReEvalInterpCurve)
+		{
+			EvalLineInterpCurve(LineData, AllottedGeometry, DrawScale);
+		}
+
+		if (LineData.bNeedRebuildLocalGeometry || NeedRebuildLocalGeometry(LineData, DrawScale))
+		{
+			BuildLocalGeometry(LineData, DrawScale);
+			TransformRenderData(LineData.RenderData, RenderTransform, ESlateVertexRounding::Enabled);
+			LineData.RenderDataTransform = RenderTransform;
+		}
+		else if (Stream.Points.Num() > Stream.NumBuiltPoints || Stream.Points.Num() - Stream.HeadPoint > Stream.Capacity)
+		{
+			int32 FirstNewVertex, HeadCapVertex;
+			ExtendStreamingGeometry(LineData, FirstNewVertex, HeadCapVertex);
+			// Otherwise the whole line is transformed by the update pass of DrawLines anyway.
+			if (LineData.RenderDataTransform == RenderTransform)
+			{
+				TransformRenderData(LineData.RenderData, RenderTransform, ESlateVertexRounding::Enabled, FirstNewVertex);
+				if (HeadCapVertex != INDEX_NONE)
+				{
+					TransformRenderData(LineData.RenderData, RenderTransform, ESlateVertexRounding::Enabled, HeadCapVertex, 4);
+				}
+			}
+		}
+		else
+		{
+			continue;
+		}
+
+		// Trimming and compaction move the points. The line has its own draw element, the batches are left alone.
+		LineData.SegmentChunkBounds.Reset();
+		UpdateLineSpatialGrid(LineIndex);
+		LineData.StaleSinceFrame = MAX_uint64;
+	}
+}
+
+void ILineDrawer::UpdateLineShapes(const FGeometry& AllottedGeometry, float DrawScale) const
+{
+	if (LineShapes.Num() == 0)
+	{
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::UpdateLineShapes);
+
+	// Also on the paint thread with async tessellation, instances can't keep drawing a shape geometry that is being replaced.
+	LineWorkItems.Reset();
+	for (auto It = LineShapes.CreateConstIterator(); It; ++It)
+	{
+		const FLineData& ShapeData = It->LineData;
+		if (It->Instances.Num() > 0 && (ShapeData.bNeedReEvalInterpCurve || ShapeData.bNeedRebuildLocalGeometry || NeedReEvalForDrawScale(ShapeData, DrawScale) || NeedRebuildLocalGeometry(ShapeData, DrawScale)))
+		{
+			LineWorkItems.Add({ It.GetIndex(), EstimateLineCost(ShapeData, true, true) });
+		}
+	}
+
+	ParallelForLines(TEXT("ILineDrawer::ParallelTessellateLineShape"), LineWorkItems, [this, &AllottedGeometry, DrawScale](int32 ShapeIndex)
+	{
+		TessellateLine(LineShapes[ShapeIndex].LineData, AllottedGeometry, DrawScale);
+	});
+
+	for (const FLineWorkItem& WorkItem : LineWorkItems)
+	{
+		for (const int32 LineIndex : LineShapes[WorkItem.Index].Instances)
+		{
+			LineDatas[LineIndex].bNeedRebuildLocalGeometry = true;
+			HotStore.MarkRenderDataStale(LineIndex);
+			UpdateLineInstanceBounds(LineIndex);
+		}
+		bDrawBatchesDirty = true;
+	}
+}
+
+void ILineDrawer::UpdateLineInstanceBounds(int32 LineIndex) const
+{
+	FLineData& LineData = LineDatas[LineIndex];
+	const FLineData& ShapeData = LineShapes[LineData.Instance->ShapeIndex].LineData;
+	if (ShapeData.SampleBounds.bIsValid)
+	{
+		LineData.SampleBounds = TransformBounds(ShapeData.SampleBounds, LineData.Instance->Transform);
+		LineData.bNeedUpdateSpatialGrid = true;
+		UpdateLineSpatialGrid(LineIndex);
+	}
+}
+
+ILineDrawer::ERenderDataUpdate ILineDrawer::UpdateLineInstanceRenderData(FLineData& InOutLineData, const FSlateRenderTransform& RenderTransform) const
+{
+	const FRenderData& ShapeRenderData = LineShapes[InOutLineData.Instance->ShapeIndex].LineData.RenderData;
+	FRenderData& RenderData = InOutLineData.RenderData;
+	ERenderDataUpdate Update = ERenderDataUpdate::Transformed;
+	if (InOutLineData.bNeedRebuildLocalGeometry)
+	{
+		// Only the texture coordinates are kept, the positions and colors are the instance's own.
+		RenderData.VertexData = ShapeRenderData.VertexData;
+		RenderData.VertexColor = GetLineVertexColor(InOutLineData.LineDescriptor);
+		for (FSlateVertex& Vertex : RenderData.VertexData)
+		{
+			Vertex.Color = RenderData.VertexColor;
+		}
+		InOutLineData.bNeedRebuildLocalGeometry = false;
+		Update = ERenderDataUpdate::Rebuilt;
+	}
+	else if (InOutLineData.RenderDataTransform == RenderTransform)
+	{
+		return ERenderDataUpdate::None;
+	}
+
+	TransformVertices(ShapeRenderData.LocalPositionX.GetData(), ShapeRenderData.LocalPositionY.GetData(), RenderData.VertexData.GetData(), RenderData.VertexData.Num(),
+		::Concatenate(InOutLineData.Instance->Transform, RenderTransform), ESlateVertexRounding::Enabled);
+	InOutLineData.RenderDataTransform = RenderTransform;
+	return Update;
+}
+
+void ILineDrawer::SetLineInstanceDescriptor(const FLineDescriptor& ShapeDescriptor, const FLineInstance& Instance, FLineDescriptor& OutLineDescriptor)
+{
+	// Thickness is only used for the culling padding of the instance, scaled like its geometry.
+	const FVector2f ScaleSquared = Instance.Transform.GetMatrix().GetScaleSquared();
+	OutLineDescriptor.Brush = ShapeDescriptor.Brush;
+	OutLineDescriptor.Brush.TintColor = ShapeDescriptor.Brush.TintColor.GetSpecifiedColor() * Instance.Tint;
+	OutLineDescriptor.Thickness = ShapeDescriptor.Thickness * FMath::Sqrt(FMath::Max(ScaleSquared.X, ScaleSquared.Y));
+}
+
+FBox2f ILineDrawer::TransformBounds(const FBox2f& Bounds, const FSlateRenderTransform& Transform)
+{
+	FBox2f TransformedBounds(ForceInit);
+	TransformedBounds += Transform.TransformPoint(Bounds.Min);
+	TransformedBounds += Transform.TransformPoint(FVector2f(Bounds.Max.X, Bounds.Min.Y));
+	TransformedBounds += Transform.TransformPoint(FVector2f(Bounds.Min.X, Bounds.Max.Y));
+	TransformedBounds += Transform.TransformPoint(Bounds.Max);
+	return TransformedBounds;
+}
+
+void ILineDrawer::UpdateFromLineSource() const
+{
+	if (!LineSource)
+	{
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::UpdateFromLineSource);
+
+	// Only the source samples its lines, when it is painted. Lines it hasn't sampled yet keep the geometry of this view until then,
+	// the source flags them again once it has.
+	bool bAnyLineChanged = false;
+	for (TConstSetBitIterator<> It(PendingSourceLines); It; ++It)
+	{
+		const int32 LineIndex = It.GetIndex();
+		const TSparseArray<FLineData>& SourceLineDatas = LineSource->LineDatas;
+		const FLineData* SourceData = SourceLineDatas.IsValidIndex(LineIndex) && !SourceLineDatas[LineIndex].Instance ? &SourceLineDatas[LineIndex] : nullptr;
+		bAnyLineChanged = true;
+		if (!SourceData || SourceData->bTessellationInFlight || SourceData->bNeedReEvalInterpCurve)
+		{
+			continue;
+		}
+
+		if (!LineDatas.IsValidIndex(LineIndex))
+		{
+			LineDatas.EmplaceAt(LineIndex);
+			LineDatas[LineIndex].Serial = SourceData->Serial;
+			HotStore.Add(LineIndex);
+		}
+
+		FLineData& LineData = LineDatas[LineIndex];
+		CopyLineStyle(SourceData->LineDescriptor, LineData.LineDescriptor);
+		LineData.LineLength = SourceData->LineLength;
+		LineData.SampleBounds = SourceData->SampleBounds;
+		LineData.DecimationDrawScale = 0.0f;
+		LineData.RenderData.RenderingResourceHandle = FSlateResourceHandle();
+		LineData.bNeedRebuildLocalGeometry = true;
+		LineData.bNeedUpdateSpatialGrid = true;
+		UpdateLineSpatialGrid(LineIndex);
+		HotStore.MarkRenderDataStale(LineIndex);
+	}
+
+	if (bAnyLineChanged)
+	{
+		PendingSourceLines.SetRange(0, PendingSourceLines.Num(), false);
+		bDrawBatchesDirty = true;
+	}
+}
+
+void ILineDrawer::RequestLineViewsRepaint() const
+{
+	// A view painted before its source this frame only picks up what the source just sampled on its next paint.
+	TArray<TWeakPtr<SWidget>, TInlineAllocator<2>> WeakWidgets;
+	for (ILineDrawer* LineView : LineViews)
+	{
+		if (LineView->PendingSourceLines.Find(true) != INDEX_NONE)
+		{
+			WeakWidgets.Add(LineView->GetLineDrawerWidget().AsShared());
+		}
+	}
+	if (WeakWidgets.Num() == 0)
+	{
+		return;
+	}
+
+	// Not from within the paint of the source.
+	AsyncTask(ENamedThreads::GameThread, [WeakWidgets = MoveTemp(WeakWidgets)]()
+	{
+		for (const TWeakPtr<SWidget>& WeakWidget : WeakWidgets)
+		{
+			if (TSharedPtr<SWidget> Widget = WeakWidget.Pin())
+			{
+				Widget->Invalidate(EInvalidateWidgetReason::Paint);
+			}
+		}
+	});
+}
+
+ILineDrawer::ERenderDataUpdate ILineDrawer::UpdateMirroredLineRenderData(int32 LineIndex, FLineData& InOutLineData, const FSlateRenderTransform& RenderTransform, float DrawScale) const
+{
+	// Lines in flight in the source keep the geometry this view last built for them.
+	const FLineData& SourceData = LineSource->LineDatas[LineIndex];
+	if (SourceData.bTessellationInFlight || (!InOutLineData.bNeedRebuildLocalGeometry && !NeedRebuildLocalGeometry(InOutLineData, DrawScale)))
+	{
+		if (InOutLineData.RenderDataTransform == RenderTransform)
+		{
+			return ERenderDataUpdate::None;
+		}
+
+		TransformRenderData(InOutLineData.RenderData, RenderTransform, ESlateVertexRounding::Enabled);
+		InOutLineData.RenderDataTransform = RenderTransform;
+		return ERenderDataUpdate::Transformed;
+	}
+
+	BuildLocalGeometry(InOutLineData, DrawScale, GetLinePoints(SourceData), SourceData.LineLength);
+	TransformRenderData(InOutLineData.RenderData, RenderTransform, ESlateVertexRounding::Enabled);
+	InOutLineData.RenderDataTransform = RenderTransform;
+	return ERenderDataUpdate::Rebuilt;
+}
+
+void ILineDrawer::PublishFrameCounters()
+{
+	FLineDrawerFrameCounters& Counters = GLineDrawerFrameCounters;
+	if (Counters.LastPublishedFrame == GFrameCounter)
+	{
+		return;
+	}
+	Counters.LastPublishedFrame = GFrameCounter;
+
+	// Published by the first drawer painted in a frame, so they describe the work of all the drawers in the previous frame.
+	const uint32 NumReEvaluatedLines = Counters.NumReEvaluatedLines.exchange(0, std::memory_order_relaxed);
+	const uint32 NumRetriangulatedLines = Counters.NumRetriangulatedLines.exchange(0, std::memory_order_relaxed);
+	const uint32 NumDecimatedPoints = Counters.NumDecimatedPoints.exchange(0, std::memory_order_relaxed);
+	const float CurveEvaluationTime = FPlatformTime::ToMilliseconds64(Counters.CurveEvaluationCycles.exchange(0, std::memory_order_relaxed));
+	const float GeometryBuildingTime = FPlatformTime::ToMilliseconds64(Counters.GeometryBuildingCycles.exchange(0, std::memory_order_relaxed));
+	const uint32 NumVertices = Counters.NumVertices;
+	const uint32 NumIndices = Counters.NumIndices;
+	const uint32 NumDrawElements = Counters.NumDrawElements;
+	const uint32 NumLineCommands = Counters.NumLineCommands;
+	const uint32 NumCoalescedLineCommands = Counters.NumCoalescedLineCommands;
+	Counters.NumVertices = Counters.NumIndices = Counters.NumDrawElements = Counters.NumLineCommands = Counters.NumCoalescedLineCommands = 0;
+
+	bool bCollectTotals = false;
+#if STATS
+	bCollectTotals |= FThreadStats::IsCollectingData();
+#endif
+#if COUNTERSTRACE_ENABLED
+	bCollectTotals |= UE_TRACE_CHANNELEXPR_IS_ENABLED(CountersChannel);
+#endif
+	if (!bCollectTotals)
+	{
+		return;
+	}
+
+	int32 NumLines = 0;
+	int32 NumSamplePoints = 0;
+	SIZE_T RenderDataMemory = 0;
+	SIZE_T BufferPoolMemory = 0;
+	for (const ILineDrawer* LineDrawer : GLineDrawers)
+	{
+		NumLines += LineDrawer->LineDatas.Num();
+		BufferPoolMemory += LineDrawer->BufferPool.AllocatedSize;
+		for (const FLineData& LineData : LineDrawer->LineDatas)
+		{
+			NumSamplePoints += GetLinePoints(LineData).Num();
+			RenderDataMemory += GetRenderDataAllocatedSize(LineData.RenderData);
+		}
+		for (const FDrawBatch& DrawBatch : LineDrawer->DrawBatches)
+		{
+			RenderDataMemory += DrawBatch.VertexData.GetAllocatedSize() + DrawBatch.IndexData.GetAllocatedSize();
+		}
+	}
+
+	SET_DWORD_STAT(STAT_LineDrawer_Lines, NumLines);
+	SET_DWORD_STAT(STAT_LineDrawer_ReEvaluatedLines, NumReEvaluatedLines);
+	SET_DWORD_STAT(STAT_LineDrawer_LineCommands, NumLineCommands);
+	SET_DWORD_STAT(STAT_LineDrawer_CoalescedLineCommands, NumCoalescedLineCommands);
+	SET_DWORD_STAT(STAT_LineDrawer_RetriangulatedLines, NumRetriangulatedLines);
+	SET_DWORD_STAT(STAT_LineDrawer_SamplePoints, NumSamplePoints);
+	SET_DWORD_STAT(STAT_LineDrawer_DecimatedPoints, NumDecimatedPoints);
+	SET_MEMORY_STAT(STAT_LineDrawer_RenderDataMemory, RenderDataMemory);
+	SET_MEMORY_STAT(STAT_LineDrawer_BufferPoolMemory, BufferPoolMemory);
+	SET_FLOAT_STAT(STAT_LineDrawer_CurveEvaluationTime, CurveEvaluationTime);
+	SET_FLOAT_STAT(STAT_LineDrawer_GeometryBuildingTime, GeometryBuildingTime);
+
+	TRACE_COUNTER_SET(LineDrawer_Lines, NumLines);
+	TRACE_COUNTER_SET(LineDrawer_ReEvaluatedLines, NumReEvaluatedLines);
+	TRACE_COUNTER_SET(LineDrawer_LineCommands, NumLineCommands);
+	TRACE_COUNTER_SET(LineDrawer_CoalescedLineCommands, NumCoalescedLineCommands);
+	TRACE_COUNTER_SET(LineDrawer_RetriangulatedLines, NumRetriangulatedLines);
+	TRACE_COUNTER_SET(LineDrawer_SamplePoints, NumSamplePoints);
+	TRACE_COUNTER_SET(LineDrawer_DecimatedPoints, NumDecimatedPoints);
+	TRACE_COUNTER_SET(LineDrawer_Vertices, NumVertices);
+	TRACE_COUNTER_SET(LineDrawer_Indices, NumIndices);
+	TRACE_COUNTER_SET(LineDrawer_RenderDataMemory, RenderDataMemory);
+	TRACE_COUNTER_SET(LineDrawer_BufferPoolMemory, BufferPoolMemory);
+	TRACE_COUNTER_SET(LineDrawer_DrawElements, NumDrawElements);
+	TRACE_COUNTER_SET(LineDrawer_CurveEvaluationTime, CurveEvaluationTime);
+	TRACE_COUNTER_SET(LineDrawer_GeometryBuildingTime, GeometryBuildingTime);
+}
+
+SIZE_T ILineDrawer::GetRenderDataAllocatedSize(const FRenderData& RenderData)
+{
+	return RenderData.LocalPositionX.GetAllocatedSize() + RenderData.LocalPositionY.GetAllocatedSize() + RenderData.VertexData.GetAllocatedSize() + RenderData.IndexData.GetAllocatedSize();
+}
+
+void ILineDrawer::DumpExpensiveLines(int32 NumLinesToDump, FOutputDevice& Ar)
+{
+	for (ILineDrawer* LineDrawer : GLineDrawers)
+	{
+		SWidget& Widget = LineDrawer->GetLineDrawerWidget();
+		Ar.Logf(TEXT("%s %p: %d lines, %d visible, %d draw elements"), *Widget.GetTypeAsString(), &Widget, LineDrawer->LineDatas.Num(), LineDrawer->VisibleLines.Num(), LineDrawer->DrawBatches.Num());
+
+		// Ranked by the cost of evaluating and building the line from scratch, the same estimate used to balance the parallel passes.
+		TArray<FLineWorkItem> LinesByCost;
+		LinesByCost.Reserve(LineDrawer->LineDatas.Num());
+		for (auto It = LineDrawer->LineDatas.CreateConstIterator(); It; ++It)
+		{
+			LinesByCost.Add({ It.GetIndex(), EstimateLineCost(*It, true, true) });
+		}
+		Algo::SortBy(LinesByCost, &FLineWorkItem::Cost, TGreater<>());
+
+		Ar.Logf(TEXT("  %8s %10s %8s %8s %9s %9s %10s"), TEXT("Line"), TEXT("Cost"), TEXT("Keys"), TEXT("Samples"), TEXT("Vertices"), TEXT("Indices"), TEXT("Bytes"));
+		for (int32 Index = 0; Index < FMath::Min(NumLinesToDump, LinesByCost.Num()); ++Index)
+		{
+			const FLineData& LineData = LineDrawer->LineDatas[LinesByCost[Index].Index];
+			Ar.Logf(TEXT("  %8d %10u %8d %8d %9d %9d %10llu"), LinesByCost[Index].Index, LinesByCost[Index].Cost, LineData.LineDescriptor.InterpCurve.Points.Num(), GetLinePoints(LineData).Num(),
+				LineData.RenderData.VertexData.Num(), LineData.RenderData.IndexData.Num(), static_cast<uint64>(GetRenderDataAllocatedSize(LineData.RenderData)));
+		}
+	}
+}
+
+void ILineDrawer::Compact()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::Compact);
+
+	BufferPool.Empty();
+
+	auto ShrinkIfSlack = [](auto& Array)
+	{
+		if (Array.GetSlack() > Array.Max() * GLineDrawerCompactSlackRatio)
+		{
+			Array.Shrink();
+		}
+	};
+	for (FLineData& LineData : LineDatas)
+	{
+		ShrinkIfSlack(LineData.LineDescriptor.InterpCurve.Points);
+		ShrinkIfSlack(LineData.SampledKeys);
+		ShrinkIfSlack(LineData.InterpCurveSamplePoints);
+		ShrinkIfSlack(LineData.IntervalSampleOffsets);
+		ShrinkIfSlack(LineData.RenderData.LocalPositionX);
+		ShrinkIfSlack(LineData.RenderData.LocalPositionY);
+		ShrinkIfSlack(LineData.RenderData.VertexData);
+		ShrinkIfSlack(LineData.RenderData.IndexData);
+	}
+	for (FLineShape& Shape : LineShapes)
+	{
+		ShrinkIfSlack(Shape.Instances);
+	}
+	for (FDrawBatch& DrawBatch : DrawBatches)
+	{
+		ShrinkIfSlack(DrawBatch.VertexData);
+		ShrinkIfSlack(DrawBatch.IndexData);
+	}
+
+	// Line indices are handles, so only the free slots at the end of the sparse array can go.
+	LineDatas.Shrink();
+	HotStore.Shrink();
+	DrawBatches.Shrink();
+	LineWorkItems.Empty();
+	PendingInterpCurveLines.Shrink();
+	VisibleLines.Shrink();
+	PrevVisibleLines.Shrink();
+}
+
+ILineDrawer::FMemoryReport ILineDrawer::GetMemoryReport() const
+{
+	auto GetSlackBytes = [](const auto& Array)
+	{
+		return static_cast<SIZE_T>(Array.GetSlack()) * Array.GetTypeSize();
+	};
+
+	FMemoryReport Report;
+	Report.NumLines = LineDatas.Num();
+	Report.NumPooledBuffers = BufferPool.Num();
+	Report.LineDataBytes = LineDatas.GetAllocatedSize() + HotStore.GetAllocatedSize();
+	Report.BufferPoolBytes = BufferPool.AllocatedSize;
+	Report.LineDataBytes += LineShapes.GetAllocatedSize();
+	for (const FLineShape& Shape : LineShapes)
+	{
+		const FLineData& ShapeData = Shape.LineData;
+		Report.LineDataBytes += Shape.Instances.GetAllocatedSize();
+		Report.KeyPointBytes += ShapeData.LineDescriptor.InterpCurve.Points.GetAllocatedSize() + ShapeData.SampledKeys.GetAllocatedSize();
+		Report.SamplePointBytes += ShapeData.InterpCurveSamplePoints.GetAllocatedSize() + ShapeData.IntervalSampleOffsets.GetAllocatedSize() + ShapeData.DecimatedPoints.GetAllocatedSize()
+			+ ShapeData.SegmentChunkBounds.GetAllocatedSize();
+		Report.RenderDataBytes += GetRenderDataAllocatedSize(ShapeData.RenderData);
+	}
+	for (const FLineData& LineData : LineDatas)
+	{
+		const FRenderData& RenderData = LineData.RenderData;
+		Report.KeyPointBytes += LineData.LineDescriptor.InterpCurve.Points.GetAllocatedSize() + LineData.SampledKeys.GetAllocatedSize();
+		Report.SamplePointBytes += LineData.InterpCurveSamplePoints.GetAllocatedSize() + LineData.IntervalSampleOffsets.GetAllocatedSize() + LineData.DecimatedPoints.GetAllocatedSize()
+			+ LineData.SegmentChunkBounds.GetAllocatedSize();
+		Report.RenderDataBytes += GetRenderDataAllocatedSize(RenderData);
+		Report.SlackBytes += GetSlackBytes(LineData.LineDescriptor.InterpCurve.Points) + GetSlackBytes(LineData.InterpCurveSamplePoints) + GetSlackBytes(LineData.IntervalSampleOffsets)
+			+ GetSlackBytes(RenderData.LocalPositionX) + GetSlackBytes(RenderData.LocalPositionY) + GetSlackBytes(RenderData.VertexData) + GetSlackBytes(RenderData.IndexData);
+		if (const FStreamingLine* Stream = LineData.Streaming.Get())
+		{
+			Report.SamplePointBytes += sizeof(FStreamingLine) + Stream->Points.GetAllocatedSize() + Stream->ArcLengths.GetAllocatedSize()
+				+ Stream->FirstVertices.GetAllocatedSize() + Stream->FirstIndices.GetAllocatedSize() + Stream->MiterJoins.GetAllocatedSize();
+			Report.SlackBytes += GetSlackBytes(Stream->Points) + GetSlackBytes(Stream->ArcLengths) + GetSlackBytes(Stream->FirstVertices) + GetSlackBytes(Stream->FirstIndices) + GetSlackBytes(Stream->MiterJoins);
+		}
+		if (LineData.Instance)
+		{
+			Report.LineDataBytes += sizeof(FLineInstance);
+		}
+	}
+	for (const FDrawBatch& DrawBatch : DrawBatches)
+	{
+		Report.DrawBatchBytes += DrawBatch.VertexData.GetAllocatedSize() + DrawBatch.IndexData.GetAllocatedSize();
+	}
+	return Report;
+}
+
+void ILineDrawer::DumpMemoryReport(FOutputDevice& Ar)
+{
+	SIZE_T TotalBytes = 0;
+	for (ILineDrawer* LineDrawer : GLineDrawers)
+	{
+		const FMemoryReport Report = LineDrawer->GetMemoryReport();
+		TotalBytes += Report.GetTotalBytes();
+
+		SWidget& Widget = LineDrawer->GetLineDrawerWidget();
+		Ar.Logf(TEXT("%s %p: %d lines, %.1f KB"), *Widget.GetTypeAsString(), &Widget, Report.NumLines, Report.GetTotalBytes() / 1024.0);
+		Ar.Logf(TEXT("  Line data %.1f KB, key points %.1f KB, sample points %.1f KB, render data %.1f KB, draw batches %.1f KB"),
+			Report.LineDataBytes / 1024.0, Report.KeyPointBytes / 1024.0, Report.SamplePointBytes / 1024.0, Report.RenderDataBytes / 1024.0, Report.DrawBatchBytes / 1024.0);
+		Ar.Logf(TEXT("  Buffer pool %.1f KB in %d buffer sets, slack %.1f KB"), Report.BufferPoolBytes / 1024.0, Report.NumPooledBuffers, Report.SlackBytes / 1024.0);
+	}
+	Ar.Logf(TEXT("%d line drawers, %.1f KB in total"), GLineDrawers.Num(), TotalBytes / 1024.0);
+}
+
+void ILineDrawer::SaveLinesSnapshot(TArray<uint8>& OutData, bool bWithGeometry) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::SaveLinesSnapshot);
+
+	// The samples of the lines in flight are with their job.
+	ApplyFinishedTessellationJobs(HotStore.RenderTransform, true);
+
+	FLinesSnapshotHeader Header;
+	FMemory::Memzero(Header);
+	Header.Magic = LinesSnapshotMagic;
+	Header.Version = LinesSnapshotVersion;
+	Header.Format = GetLinesSnapshotFormat();
+	Header.SamplerHash = GetLinesSnapshotSamplerHash();
+
+	// Diagrams draw many lines with the same few brushes, each of them is serialized once.
+	TArray<FSlateBrush> Brushes;
+	TMultiMap<uint32, int32> BrushesByHash;
+	TArray<FLinesSnapshotLine> Records;
+	Records.Reserve(LineDatas.Num());
+	for (auto It = LineDatas.CreateConstIterator(); It; ++It)
+	{
+		const FLineData& LineData = *It;
+		if (LineData.Streaming || LineData.Instance)
+		{
+			continue;
+		}
+
+		const FLineDescriptor& LineDescriptor = LineData.LineDescriptor;
+		const FSlateBrush& Brush = LineDescriptor.Brush;
+		const uint32 BrushHash = HashCombineFast(HashCombineFast(GetTypeHash(Brush.GetResourceName()), PointerHash(Brush.GetResourceObject())), GetTypeHash(Brush.TintColor.GetSpecifiedColor()));
+		int32 BrushIndex = INDEX_NONE;
+		for (auto BrushIt = BrushesByHash.CreateConstKeyIterator(BrushHash); BrushIt && BrushIndex == INDEX_NONE; ++BrushIt)
+		{
+			BrushIndex = Brushes[BrushIt.Value()] == Brush ? BrushIt.Value() : INDEX_NONE;
+		}
+		if (BrushIndex == INDEX_NONE)
+		{
+			BrushIndex = Brushes.Add(Brush);
+			BrushesByHash.Add(BrushHash, BrushIndex);
+		}
+
+		FLinesSnapshotLine& Record = Records.AddZeroed_GetRef();
+		Record.LineIndex = It.GetIndex();
+		Record.BrushIndex = BrushIndex;
+		Record.FirstKey = Header.NumKeys;
+		Record.NumKeys = LineDescriptor.InterpCurve.Points.Num();
+		Header.NumKeys += Record.NumKeys;
+		Record.FirstPolylinePoint = Record.NumPolylinePoints = INDEX_NONE;
+		if (LineDescriptor.IsPolyline())
+		{
+			Record.FirstPolylinePoint = Header.NumPolylinePoints;
+			Record.NumPolylinePoints = LineDescriptor.PolylinePoints->Num();
+			Header.NumPolylinePoints += Record.NumPolylinePoints;
+		}
+
+		// The samples are saved with the keys they were made from, so loading can take them as they are.
+		Record.bSampled = !LineData.bNeedReEvalInterpCurve && IsCurveSampled(LineData);
+		if (Record.bSampled)
+		{
+			Record.FirstSample = Header.NumSamples;
+			Record.NumSamples = LineData.InterpCurveSamplePoints.Num();
+			Header.NumSamples += Record.NumSamples;
+			Record.FirstIntervalOffset = Header.NumIntervalOffsets;
+			Record.NumIntervalOffsets = LineData.IntervalSampleOffsets.Num();
+			Header.NumIntervalOffsets += Record.NumIntervalOffsets;
+			Record.FirstSampledKey = LineData.FirstSampledKey;
+			Record.DynamicResolutionScale = LineData.SampledCurveSettings.DynamicResolutionScale;
+			Record.LocalTolerance = LineData.SampledCurveSettings.LocalTolerance;
+			Record.LineLength = LineData.LineLength;
+			Record.SampleDrawScale = LineData.SampleDrawScale;
+			Record.bHasSampleBounds = LineData.SampleBounds.bIsValid != 0;
+			Record.SampleBoundsMin = LineData.SampleBounds.Min;
+			Record.SampleBoundsMax = LineData.SampleBounds.Max;
+		}
+
+		// The decimated points are not saved, the geometry built from them is rebuilt with them.
+		if (bWithGeometry && Record.bSampled && !LineData.bNeedRebuildLocalGeometry && LineData.LocalGeometryDrawScale > 0.0f && LineData.DecimatedPoints.Num() == 0)
+		{
+			const FRenderData& RenderData = LineData.RenderData;
+			Record.FirstVertex = Header.NumVertices;
+			Record.NumVertices = RenderData.VertexData.Num();
+			Header.NumVertices += Record.NumVertices;
+			Record.FirstIndex = Header.NumIndices;
+			Record.NumIndices = RenderData.IndexData.Num();
+			Header.NumIndices += Record.NumIndices;
+			Record.LocalGeometryDrawScale = LineData.LocalGeometryDrawScale;
+			Record.GeometryThickness = LineData.GeometryThickness;
+			Record.RenderDataTransform = LineData.RenderDataTransform;
+			Record.VertexColor = RenderData.VertexColor;
+		}
+
+		Record.Thickness = LineDescriptor.Thickness;
+		Record.Resolution = LineDescriptor.Resolution;
+		Record.DynamicResolutionFactor = LineDescriptor.DynamicResolutionFactor;
+		Record.MaxResolution = LineDescriptor.MaxResolution;
+		Record.TessellationTolerance = LineDescriptor.TessellationTolerance;
+		Record.DecimationTolerance = LineDescriptor.DecimationTolerance;
+		Record.InterpCurveStartT = LineDescriptor.InterpCurveStartT;
+		Record.InterpCurveEndT = LineDescriptor.InterpCurveEndT;
+		Record.LoopKeyOffset = LineDescriptor.InterpCurve.LoopKeyOffset;
+		Record.TessellationMode = LineDescriptor.TessellationMode;
+		Record.Decimation = LineDescriptor.Decimation;
+		Record.bIsLooped = LineDescriptor.InterpCurve.bIsLooped;
+	}
+
+	TArray<uint8> BrushTable;
+	FMemoryWriter BrushWriter(BrushTable);
+	FObjectAndNameAsStringProxyArchive BrushArchive(BrushWriter, false);
+	for (FSlateBrush& Brush : Brushes)
+	{
+		FSlateBrush::StaticStruct()->SerializeItem(BrushArchive, &Brush, nullptr);
+	}
+
+	Header.MaxLineIndex = LineDatas.GetMaxIndex();
+	Header.NumLines = Records.Num();
+	Header.NumBrushes = Brushes.Num();
+	Header.BrushTableBytes = BrushTable.Num();
+	const FLinesSnapshotLayout Layout(Header);
+	check(Layout.TotalBytes <= MAX_int32);
+	OutData.Reset();
+	OutData.SetNumZeroed(Layout.TotalBytes);
+
+	const TArrayView<uint8> Data(OutData);
+	FMemory::Memcpy(Data.GetData(), &Header, sizeof(Header));
+	FMemory::Memcpy(Data.GetData() + Layout.Lines, Records.GetData(), Records.Num() * sizeof(FLinesSnapshotLine));
+	FMemory::Memcpy(Data.GetData() + Layout.Brushes, BrushTable.GetData(), BrushTable.Num());
+
+	const TArrayView<FInterpCurvePoint<FVector2f>> Keys = GetLinesSnapshotSection<FInterpCurvePoint<FVector2f>>(Data, Layout.Keys, Header.NumKeys);
+	const TArrayView<FVector2f> Samples = GetLinesSnapshotSection<FVector2f>(Data, Layout.Samples, Header.NumSamples);
+	const TArrayView<int32> IntervalOffsets = GetLinesSnapshotSection<int32>(Data, Layout.IntervalOffsets, Header.NumIntervalOffsets);
+	const TArrayView<FVector2f> PolylinePoints = GetLinesSnapshotSection<FVector2f>(Data, Layout.PolylinePoints, Header.NumPolylinePoints);
+	const TArrayView<float> LocalPositionX = GetLinesSnapshotSection<float>(Data, Layout.LocalPositionX, Header.NumVertices);
+	const TArrayView<float> LocalPositionY = GetLinesSnapshotSection<float>(Data, Layout.LocalPositionY, Header.NumVertices);
+	const TArrayView<FSlateVertex> Vertices = GetLinesSnapshotSection<FSlateVertex>(Data, Layout.Vertices, Header.NumVertices);
+	const TArrayView<SlateIndex> Indices = GetLinesSnapshotSection<SlateIndex>(Data, Layout.Indices, Header.NumIndices);
+	auto CopyToSection = [](auto Section, int32 First, const auto& Source)
+	{
+		FMemory::Memcpy(Section.GetData() + First, Source.GetData(), Source.Num() * sizeof(*Source.GetData()));
+	};
+	for (const FLinesSnapshotLine& Record : Records)
+	{
+		const FLineData& LineData = LineDatas[Record.LineIndex];
+		CopyToSection(Keys, Record.FirstKey, LineData.LineDescriptor.InterpCurve.Points);
+		if (Record.NumPolylinePoints != INDEX_NONE)
+		{
+			CopyToSection(PolylinePoints, Record.FirstPolylinePoint, *LineData.LineDescriptor.PolylinePoints);
+		}
+		if (Record.bSampled)
+		{
+			CopyToSection(Samples, Record.FirstSample, LineData.InterpCurveSamplePoints);
+			CopyToSection(IntervalOffsets, Record.FirstIntervalOffset, LineData.IntervalSampleOffsets);
+		}
+		if (Record.NumVertices > 0)
+		{
+			const FRenderData& RenderData = LineData.RenderData;
+			CopyToSection(LocalPositionX, Record.FirstVertex, RenderData.LocalPositionX);
+			CopyToSection(LocalPositionY, Record.FirstVertex, RenderData.LocalPositionY);
+			CopyToSection(Vertices, Record.FirstVertex, RenderData.VertexData);
+			CopyToSection(Indices, Record.FirstIndex, RenderData.IndexData);
+		}
+	}
+}
+
+bool ILineDrawer::LoadLinesSnapshot(TConstArrayView<uint8> Data)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::LoadLinesSnapshot);
+	LLM_SCOPE_BYTAG(LineDrawer);
+
+	if (!EnsureNotLineView())
+	{
+		return false;
+	}
+
+	// The arrays are read in place, a blob that isn't aligned like a TArray or a mapping is read from an aligned copy.
+	TArray<uint8, TAlignedHeapAllocator<LinesSnapshotAlignment>> AlignedData;
+	if (!IsAligned(Data.GetData(), LinesSnapshotAlignment))
+	{
+		AlignedData.Append(Data.GetData(), Data.Num());
+		Data = AlignedData;
+	}
+
+	FLinesSnapshotHeader Header;
+	if (Data.Num() < static_cast<int32>(sizeof(Header)))
+	{
+		return false;
+	}
+	FMemory::Memcpy(&Header, Data.GetData(), sizeof(Header));
+	const FLinesSnapshotFormat Format = GetLinesSnapshotFormat();
+	if (Header.Magic != LinesSnapshotMagic || Header.Version != LinesSnapshotVersion || FMemory::Memcmp(&Header.Format, &Format, sizeof(Format)) != 0 || Header.NumLines < 0 || Header.NumBrushes < 0 || Header.BrushTableBytes < 0
+		|| Header.MaxLineIndex < Header.NumLines || Header.MaxLineIndex > FMath::Max(static_cast<int64>(Header.NumLines) * LinesSnapshotMaxSlotsPerLine, int64(LinesSnapshotMinSlots))
+		|| Header.NumKeys < 0 || Header.NumSamples < 0 || Header.NumIntervalOffsets < 0 || Header.NumPolylinePoints < 0 || Header.NumVertices < 0 || Header.NumIndices < 0)
+	{
+		return false;
+	}
+	const FLinesSnapshotLayout Layout(Header);
+	if (Layout.TotalBytes > Data.Num())
+	{
+		return false;
+	}
+
+	// The ranges are checked, and whatever indexes into the arrays of a line. The keys, samples and vertices are taken as they are.
+	const TConstArrayView<FLinesSnapshotLine> Records = GetLinesSnapshotSection<FLinesSnapshotLine>(Data, Layout.Lines, Header.NumLines);
+	const TConstArrayView<int32> IntervalOffsets = GetLinesSnapshotSection<int32>(Data, Layout.IntervalOffsets, Header.NumIntervalOffsets);
+	const TConstArrayView<SlateIndex> Indices = GetLinesSnapshotSection<SlateIndex>(Data, Layout.Indices, Header.NumIndices);
+	auto IsValidRange = [](int32 First, int32 Num, int32 SectionNum)
+	{
+		return First >= 0 && Num >= 0 && First <= SectionNum - Num;
+	};
+	// As EvalLineInterpCurve leaves them: an offset per sampled key interval and one for the last sample, into the samples of the line.
+	auto AreValidSamples = [&IntervalOffsets](const FLinesSnapshotLine& Record)
+	{
+		if (Record.FirstSampledKey == INDEX_NONE)
+		{
+			return Record.NumIntervalOffsets == 0;
+		}
+		if (Record.FirstSampledKey < 0 || Record.NumIntervalOffsets < 1 || static_cast<int64>(Record.FirstSampledKey) + Record.NumIntervalOffsets > Record.NumKeys + Record.bIsLooped)
+		{
+			return false;
+		}
+		int32 PrevOffset = 0;
+		for (const int32 Offset : IntervalOffsets.Slice(Record.FirstIntervalOffset, Record.NumIntervalOffsets))
+		{
+			if (Offset < PrevOffset || Offset >= Record.NumSamples)
+			{
+				return false;
+			}
+			PrevOffset = Offset;
+		}
+		return true;
+	};
+	auto AreValidIndices = [&Indices](const FLinesSnapshotLine& Record)
+	{
+		for (const SlateIndex Index : Indices.Slice(Record.FirstIndex, Record.NumIndices))
+		{
+			if (static_cast<int64>(Index) >= Record.NumVertices)
+			{
+				return false;
+			}
+		}
+		return true;
+	};
+	TBitArray<> LoadedLines(false, Header.MaxLineIndex);
+	for (const FLinesSnapshotLine& Record : Records)
+	{
+		if (Record.LineIndex < 0 || Record.LineIndex >= Header.MaxLineIndex || LoadedLines[Record.LineIndex] || Record.BrushIndex < 0 || Record.BrushIndex >= Header.NumBrushes
+			|| !IsValidRange(Record.FirstKey, Record.NumKeys, Header.NumKeys) || !IsValidRange(Record.FirstSample, Record.NumSamples, Header.NumSamples)
+			|| !IsValidRange(Record.FirstIntervalOffset, Record.NumIntervalOffsets, Header.NumIntervalOffsets)
+			|| (Record.NumPolylinePoints != INDEX_NONE && !IsValidRange(Record.FirstPolylinePoint, Record.NumPolylinePoints, Header.NumPolylinePoints))
+			|| !IsValidRange(Record.FirstVertex, Record.NumVertices, Header.NumVertices) || !IsValidRange(Record.FirstIndex, Record.NumIndices, Header.NumIndices)
+			|| Record.TessellationMode > ELineTessellationMode::ScreenSpaceTolerance || Record.Decimation > ELineDecimationMode::Tolerance
+			|| Record.bIsLooped > 1 || Record.bSampled > 1 || Record.bHasSampleBounds > 1
+			|| (Record.bSampled && !AreValidSamples(Record)) || !AreValidIndices(Record))
+		{
+			return false;
+		}
+		LoadedLines[Record.LineIndex] = true;
+	}
+
+	TArray<FSlateBrush> Brushes;
+	Brushes.SetNum(Header.NumBrushes);
+	FMemoryReaderView BrushReader(GetLinesSnapshotSection<uint8>(Data, Layout.Brushes, Header.BrushTableBytes));
+	FObjectAndNameAsStringProxyArchive BrushArchive(BrushReader, true);
+	for (FSlateBrush& Brush : Brushes)
+	{
+		FSlateBrush::StaticStruct()->SerializeItem(BrushArchive, &Brush, nullptr);
+	}
+	if (BrushReader.IsError() || BrushArchive.IsError())
+	{
+		return false;
+	}
+
+	const TConstArrayView<FInterpCurvePoint<FVector2f>> Keys = GetLinesSnapshotSection<FInterpCurvePoint<FVector2f>>(Data, Layout.Keys, Header.NumKeys);
+	const TConstArrayView<FVector2f> Samples = GetLinesSnapshotSection<FVector2f>(Data, Layout.Samples, Header.NumSamples);
+	const TConstArrayView<FVector2f> PolylinePoints = GetLinesSnapshotSection<FVector2f>(Data, Layout.PolylinePoints, Header.NumPolylinePoints);
+	const TConstArrayView<float> LocalPositionX = GetLinesSnapshotSection<float>(Data, Layout.LocalPositionX, Header.NumVertices);
+	const TConstArrayView<float> LocalPositionY = GetLinesSnapshotSection<float>(Data, Layout.LocalPositionY, Header.NumVertices);
+	const TConstArrayView<FSlateVertex> Vertices = GetLinesSnapshotSection<FSlateVertex>(Data, Layout.Vertices, Header.NumVertices);
+	const bool bSamplerMatches = Header.SamplerHash == GetLinesSnapshotSamplerHash();
+
+	RemoveAllLines();
+	ReserveLines(Records.Num());
+	for (const FLinesSnapshotLine& Record : Records)
+	{
+		FLineData NewLineData;
+		FLineDescriptor& LineDescriptor = NewLineData.LineDescriptor;
+		LineDescriptor.InterpCurve.Points.Append(Keys.GetData() + Record.FirstKey, Record.NumKeys);
+		LineDescriptor.InterpCurve.bIsLooped = Record.bIsLooped != 0;
+		LineDescriptor.InterpCurve.LoopKeyOffset = Record.LoopKeyOffset;
+		if (Record.NumPolylinePoints != INDEX_NONE)
+		{
+			LineDescriptor.SetPolylinePoints(TArray<FVector2f>(PolylinePoints.GetData() + Record.FirstPolylinePoint, Record.NumPolylinePoints));
+		}
+		LineDescriptor.Thickness = Record.Thickness;
+		LineDescriptor.Resolution = Record.Resolution;
+		LineDescriptor.DynamicResolutionFactor = Record.DynamicResolutionFactor;
+		LineDescriptor.MaxResolution = Record.MaxResolution;
+		LineDescriptor.TessellationMode = Record.TessellationMode;
+		LineDescriptor.TessellationTolerance = Record.TessellationTolerance;
+		LineDescriptor.Decimation = Record.Decimation;
+		LineDescriptor.DecimationTolerance = Record.DecimationTolerance;
+		LineDescriptor.InterpCurveStartT = Record.InterpCurveStartT;
+		LineDescriptor.InterpCurveEndT = Record.InterpCurveEndT;
+		LineDescriptor.Brush = Brushes[Record.BrushIndex];
+		NewLineData.Serial = ++NextLineSerial;
+		BufferPool.Acquire(NewLineData, Record.NumSamples);
+
+		// Only samples made from the saved keys are saved, see SaveLinesSnapshot.
+		const bool bSamplesValid = Record.bSampled != 0 && bSamplerMatches;
+		if (bSamplesValid)
+		{
+			SetSampledCurve(NewLineData);
+			NewLineData.InterpCurveSamplePoints.Append(Samples.GetData() + Record.FirstSample, Record.NumSamples);
+			NewLineData.IntervalSampleOffsets.Append(IntervalOffsets.GetData() + Record.FirstIntervalOffset, Record.NumIntervalOffsets);
+			NewLineData.FirstSampledKey = Record.FirstSampledKey;
+			NewLineData.SampledCurveSettings.DynamicResolutionScale = Record.DynamicResolutionScale;
+			NewLineData.SampledCurveSettings.LocalTolerance = Record.LocalTolerance;
+			NewLineData.LineLength = Record.LineLength;
+			NewLineData.SampleDrawScale = Record.SampleDrawScale;
+			NewLineData.SampleBounds = Record.bHasSampleBounds != 0 ? FBox2f(Record.SampleBoundsMin, Record.SampleBoundsMax) : FBox2f(ForceInit);
+			NewLineData.bNeedRebuildLocalGeometry = true;
+			NewLineData.bNeedUpdateSpatialGrid = true;
+			NewLineData.StaleSinceFrame = GFrameCounter;
+		}
+		else
+		{
+			NewLineData.bNeedReEvalInterpCurve = true;
+			NewLineData.StaleSinceFrame = GFrameCounter;
+		}
+
+		if (bSamplesValid && Record.NumVertices > 0)
+		{
+			// The vertices are those of the last paint before saving, they are transformed again if the widget moved since.
+			FRenderData& RenderData = NewLineData.RenderData;
+			RenderData.LocalPositionX.Append(LocalPositionX.GetData() + Record.FirstVertex, Record.NumVertices);
+			RenderData.LocalPositionY.Append(LocalPositionY.GetData() + Record.FirstVertex, Record.NumVertices);
+			RenderData.VertexData.Append(Vertices.GetData() + Record.FirstVertex, Record.NumVertices);
+			RenderData.IndexData.Append(Indices.GetData() + Record.FirstIndex, Record.NumIndices);
+			RenderData.VertexColor = Record.VertexColor;
+			NewLineData.RenderDataTransform = Record.RenderDataTransform;
+			NewLineData.LocalGeometryDrawScale = Record.LocalGeometryDrawScale;
+			NewLineData.GeometryThickness = Record.GeometryThickness;
+			SetDecimation(NewLineData, LineDescriptor);
+			NewLineData.bNeedRebuildLocalGeometry = false;
+			NewLineData.StaleSinceFrame = MAX_uint64;
+		}
+
+		const int32 LineIndex = Record.LineIndex;
+		LineDatas.EmplaceAt(LineIndex, MoveTemp(NewLineData));
+		HotStore.Add(LineIndex);
+		if (bSamplesValid)
+		{
+			UpdateLineSpatialGrid(LineIndex);
+		}
+		else
+		{
+			PendingInterpCurveLines.Add(LineIndex);
+		}
+	}
+
+	KickTessellationJobs();
+	bDrawBatchesDirty = true;
+	InvalidateLineDrawer();
+	return true;
+}
+
+void ILineDrawer::UpdateTessellationStats() const
+{
+	uint64 MaxLagFrames = 0;
+	int32 NumLinesInFlight = 0;
+	auto AccumulateLag = [this, &MaxLagFrames](int32 LineIndex)
+	{
+		if (LineDatas.IsValidIndex(LineIndex) && LineDatas[LineIndex].StaleSinceFrame != MAX_uint64)
+		{
+			MaxLagFrames = FMath::Max(MaxLagFrames, GFrameCounter - LineDatas[LineIndex].StaleSinceFrame);
+		}
+	};
+
+	for (const int32 LineIndex : PendingInterpCurveLines)
+	{
+		AccumulateLag(LineIndex);
+	}
+	for (const TSharedRef<FTessellationJob>& Job : TessellationJobs)
+	{
+		for (const int32 LineIndex : Job->LineIndices)
+		{
+			AccumulateLag(LineIndex);
+		}
+		NumLinesInFlight += Job->LineIndices.Num();
+	}
+	SET_DWORD_STAT(STAT_LineDrawer_LinesInFlight, NumLinesInFlight);
+	SET_DWORD_STAT(STAT_LineDrawer_MaxVisualLagFrames, static_cast<uint32>(MaxLagFrames));
+}
+
+uint32 ILineDrawer::EstimateLineCost(const FLineData& LineData, bool bNeedReEval, bool bNeedRebuild)
+{
+	// Relative weights of the work per key, per sample and per vertex. Lines that were never sampled are assumed to need a few samples per key.
+	const int32 NumKeys = LineData.LineDescriptor.IsPolyline() ? 0 : LineData.LineDescriptor.InterpCurve.Points.Num();
+	const int32 NumSamples = FMath::Max(GetLinePoints(LineData).Num(), NumKeys * 4);
+	uint32 Cost = 1;
+	if (bNeedReEval)
+	{
+		Cost += NumKeys * 8 + NumSamples * 2;
+	}
+	if (bNeedRebuild)
+	{
+		Cost += NumSamples * 8;
+	}
+	else
+	{
+		Cost += LineData.RenderData.VertexData.Num() / 4;
+	}
+	return Cost;
+}
+
+void ILineDrawer::ParallelForLines(const TCHAR* DebugName, TArray<FLineWorkItem>& WorkItems, TFunctionRef<void(int32 Index)> Body)
+{
+	const EParallelForFlags Flags = GLineDrawerForceSingleThread ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None;
+	if (!GLineDrawerCostBalancedScheduling)
+	{
+		ParallelFor(DebugName, WorkItems.Num(), GLineDrawerUpdateLineNumInParallel, [&WorkItems, Body](int32 Index)
+		{
+			LLM_SCOPE_BYTAG(LineDrawer);
+			Body(WorkItems[Index].Index);
+		}, Flags);
+		return;
+	}
+
+	if (GLineDrawerForceSingleThread || WorkItems.Num() <= 1)
+	{
+		for (const FLineWorkItem& WorkItem : WorkItems)
+		{
+			Body(WorkItem.Index);
+		}
+		return;
+	}
+
+	// Most expensive first, then cut into contiguous batches of about the same total cost. Heavy lines end up alone in a batch while
+	// cheap ones are grouped, and there are a few batches per worker so the ones that finish early pick up the rest.
+	Algo::SortBy(WorkItems, &FLineWorkItem::Cost, TGreater<>());
+	uint64 TotalCost = 0;
+	for (const FLineWorkItem& WorkItem : WorkItems)
+	{
+		TotalCost += WorkItem.Cost;
+	}
+
+	constexpr int32 BatchesPerWorker = 4;
+	const int32 NumWorkers = FMath::Max(FTaskGraphInterface::Get().GetNumWorkerThreads(), 1) + 1;
+	const uint64 TargetBatchCost = FMath::Max<uint64>(TotalCost / (NumWorkers * BatchesPerWorker), 1);
+	TArray<int32, TInlineAllocator<64>> BatchStarts;
+	uint64 BatchCost = TargetBatchCost;
+	for (int32 Index = 0; Index < WorkItems.Num(); ++Index)
+	{
+		if (BatchCost >= TargetBatchCost)
+		{
+			BatchStarts.Add(Index);
+			BatchCost = 0;
+		}
+		BatchCost += WorkItems[Index].Cost;
+	}
+	BatchStarts.Add(WorkItems.Num());
+
+	ParallelFor(DebugName, BatchStarts.Num() - 1, 1, [&WorkItems, &BatchStarts, Body](int32 BatchIndex)
+	{
+		LLM_SCOPE_BYTAG(LineDrawer);
+		for (int32 Index = BatchStarts[BatchIndex]; Index < BatchStarts[BatchIndex + 1]; ++Index)
+		{
+			Body(WorkItems[Index].Index);
+		}
+	}, Flags);
+}
+
+void ILineDrawer::UpdateLineSpatialGrid(int32 LineIndex) const
+{
+	FLineData& LineData = LineDatas[LineIndex];
+	if (LineData.bNeedUpdateSpatialGrid)
+	{
+		SpatialGrid.UpdateLine(LineIndex, LineData);
+		const int32 Slot = HotStore.LineSlots[LineIndex];
+		HotStore.CullBounds[Slot] = LineData.SampleBounds;
+		HotStore.PixelPaddings[Slot] = GetLinePixelPadding(LineData.LineDescriptor);
+		MaxLinePixelPadding = FMath::Max(MaxLinePixelPadding, HotStore.PixelPaddings[Slot]);
+		LineData.bNeedUpdateSpatialGrid = false;
+		// Every change of the samples of a line ends up here.
+		NotifyLineViews(LineIndex);
+	}
+}
+
+bool ILineDrawer::GatherVisibleLines(const FSlateRect& CullingRect, const FSlateRenderTransform& RenderTransform, float DrawScale) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::GatherVisibleLines);
+
+	const FSlateRenderTransform InverseRenderTransform = RenderTransform.Inverse();
+	FBox2f LocalCullingBounds(ForceInit);
+	LocalCullingBounds += InverseRenderTransform.TransformPoint(FVector2f(CullingRect.Left, CullingRect.Top));
+	LocalCullingBounds += InverseRenderTransform.TransformPoint(FVector2f(CullingRect.Right, CullingRect.Top));
+	LocalCullingBounds += InverseRenderTransform.TransformPoint(FVector2f(CullingRect.Left, CullingRect.Bottom));
+	LocalCullingBounds += InverseRenderTransform.TransformPoint(FVector2f(CullingRect.Right, CullingRect.Bottom));
+
+	// Line widths are constant in pixels, so the padding is applied in local space divided by the DrawScale the geometry is built with.
+	const float LocalPaddingScale = 1.0f / FMath::Max(DrawScale, KINDA_SMALL_NUMBER);
+
+	Swap(VisibleLines, PrevVisibleLines);
+	VisibleLines.Reset();
+	SpatialGrid.Query(LocalCullingBounds.ExpandBy(MaxLinePixelPadding * LocalPaddingScale), LineDatas.GetMaxIndex(), SpatialQueryVisitedLines, VisibleLines);
+	VisibleLines.RemoveAll([this, &LocalCullingBounds, LocalPaddingScale](int32 LineIndex)
+	{
+		const int32 Slot = HotStore.LineSlots[LineIndex];
+		return !HotStore.CullBounds[Slot].ExpandBy(HotStore.PixelPaddings[Slot] * LocalPaddingScale).Intersect(LocalCullingBounds);
+	});
+	Algo::Sort(VisibleLines);
+
+	return VisibleLines != PrevVisibleLines;
+}
+
+void ILineDrawer::RebuildDrawBatches() const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::RebuildDrawBatches);
+
+	constexpr int64 MaxBatchVertices = static_cast<int64>(TNumericLimits<SlateIndex>::Max()) + 1;
+	TMap<const FSlateResourceProxy*, int32, TInlineSetAllocator<8>> SharedBatchIndices;
+	DrawBatches.Reset();
+	VisibleStreamingLines.Reset();
+
+	for (const int32 LineIndex : VisibleLines)
+	{
+		FLineData& LineData = LineDatas[LineIndex];
+		FRenderData& RenderData = LineData.RenderData;
+		const TArray<SlateIndex>& IndexData = LineData.Instance ? LineShapes[LineData.Instance->ShapeIndex].LineData.RenderData.IndexData : RenderData.IndexData;
+		// A streaming line without geometry yet gets it from appends, which don't rebuild the batches.
+		if (!LineData.Streaming && (RenderData.VertexData.Num() == 0 || IndexData.Num() == 0))
+		{
+			continue;
+		}
+
+		// Without a Slate renderer, as in the benchmark commandlet, every line goes into the batch of the null resource.
+		if (!RenderData.RenderingResourceHandle.IsValid() && FSlateApplication::IsInitialized())
+		{
+			RenderData.RenderingResourceHandle = FSlateApplication::Get().GetRenderer()->GetResourceHandle(LineData.LineDescriptor.Brush);
+			RenderData.ResourceObject = LineData.LineDescriptor.Brush.GetResourceObject();
+			RenderData.ResourceName = LineData.LineDescriptor.Brush.GetResourceName();
+			RenderData.bHasDynamicMaterial = Cast<UMaterialInstanceDynamic>(LineData.LineDescriptor.Brush.GetResourceObject()) != nullptr;
+		}
+
+		if (LineData.Streaming)
+		{
+			VisibleStreamingLines.Add(LineIndex);
+			continue;
+		}
+
+		// Lines with their own material instance keep their own draw element, every other line is merged with the lines sharing its resource.
+		const FSlateResourceProxy* ResourceProxy = RenderData.RenderingResourceHandle.GetResourceProxy();
+		int32 BatchIndex = INDEX_NONE;
+		if (!RenderData.bHasDynamicMaterial)
+		{
+			if (const int32* SharedBatchIndex = SharedBatchIndices.Find(ResourceProxy))
+			{
+				BatchIndex = *SharedBatchIndex;
+			}
+		}
+
+		if (BatchIndex != INDEX_NONE && static_cast<int64>(DrawBatches[BatchIndex].VertexData.Num()) + RenderData.VertexData.Num() > MaxBatchVertices)
+		{
+			BatchIndex = INDEX_NONE;
+		}
+
+		if (BatchIndex == INDEX_NONE)
+		{
+			BatchIndex = DrawBatches.AddDefaulted();
+			DrawBatches[BatchIndex].RenderingResourceHandle = RenderData.RenderingResourceHandle;
+			if (!RenderData.bHasDynamicMaterial)
+			{
+				SharedBatchIndices.Add(ResourceProxy, BatchIndex);
+			}
+		}
+
+		FDrawBatch& DrawBatch = DrawBatches[BatchIndex];
+		const SlateIndex BaseVertexIndex = static_cast<SlateIndex>(DrawBatch.VertexData.Num());
+		RenderData.DrawBatchIndex = BatchIndex;
+		RenderData.DrawBatchFirstVertex = DrawBatch.VertexData.Num();
+		RenderData.DrawBatchesVersion = DrawBatchesVersion + 1;
+		const int32 FirstIndex = DrawBatch.IndexData.Num();
+		DrawBatch.VertexData.Append(RenderData.VertexData);
+		DrawBatch.IndexData.Append(IndexData);
+		for (int32 Index = FirstIndex; Index < DrawBatch.IndexData.Num(); ++Index)
+		{
+			DrawBatch.IndexData[Index] += BaseVertexIndex;
+		}
+	}
+
+	for (int32 Index = 0; Index < VisibleStreamingLines.Num(); ++Index)
+	{
+		FRenderData& RenderData = LineDatas[VisibleStreamingLines[Index]].RenderData;
+		RenderData.DrawBatchIndex = DrawBatches.Num() + Index;
+		RenderData.DrawBatchFirstVertex = 0;
+		RenderData.DrawBatchesVersion = DrawBatchesVersion + 1;
+	}
+
+	++DrawBatchesVersion;
+	bDrawBatchesDirty = false;
+}
+
+uint64 ILineDrawer::GetLineDrawOrder(const FLineData& LineData) const
+{
+	const FRenderData& RenderData = LineData.RenderData;
+	if (RenderData.DrawBatchesVersion != DrawBatchesVersion || RenderData.DrawBatchIndex == INDEX_NONE)
+	{
+		return 0;
+	}
+	// Batches are drawn in order, and the lines of a batch in the order of their vertices.
+	return (static_cast<uint64>(RenderData.DrawBatchIndex) + 1) << 32 | static_cast<uint32>(RenderData.DrawBatchFirstVertex);
+}
+
+void ILineDrawer::EvalLineInterpCurve(FLineData& InOutLineData, const FGeometry& AllottedGeometry, float DrawScale)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::EvalLineInterpCurve);
+	FScopedLineDrawerCycles ScopedCycles(GLineDrawerFrameCounters.CurveEvaluationCycles);
+	GLineDrawerFrameCounters.NumReEvaluatedLines.fetch_add(1, std::memory_order_relaxed);
+
+	auto& LineDescriptor = InOutLineData.LineDescriptor;
+	const auto& KeyPoints = LineDescriptor.InterpCurve.Points;
+	InOutLineData.InterpCurveSamplePoints.Reset();
+	InOutLineData.IntervalSampleOffsets.Reset();
+	InOutLineData.FirstSampledKey = INDEX_NONE;
+	InOutLineData.LineLength = 0.0f;
+	InOutLineData.SampleBounds = FBox2f(ForceInit);
+	InOutLineData.SampleDrawScale = DrawScale;
+	InOutLineData.DecimationDrawScale = 0.0f;
+	InOutLineData.SegmentChunkBounds.Reset();
+	InOutLineData.bNeedReEvalInterpCurve = false;
+	InOutLineData.bNeedRebuildLocalGeometry = true;
+	InOutLineData.bNeedUpdateSpatialGrid = true;
+	InOutLineData.DirtyKeyBegin = InOutLineData.DirtyKeyEnd = INDEX_NONE;
+	SetSampledCurve(InOutLineData);
+
+	if (InOutLineData.Streaming)
+	{
+		const FStreamingLine& Stream = *InOutLineData.Streaming;
+		for (int32 Point = Stream.HeadPoint; Point < Stream.Points.Num(); ++Point)
+		{
+			InOutLineData.SampleBounds += Stream.Points[Point];
+		}
+		InOutLineData.LineLength = Stream.Points.Num() > Stream.HeadPoint ? Stream.ArcLengths.Last() - Stream.ArcLengths[Stream.HeadPoint] : 0.0f;
+		return;
+	}
+
+	if (LineDescriptor.IsPolyline())
+	{
+		// The points are drawn as they are, only their bounds and length are needed.
+		const TArray<FVector2f>& Points = *LineDescriptor.PolylinePoints;
+		float LineLength = 0.0f;
+		for (int32 Index = 0; Index < Points.Num(); ++Index)
+		{
+			InOutLineData.SampleBounds += Points[Index];
+			if (Index > 0)
+			{
+				LineLength += (Points[Index] - Points[Index - 1]).Size();
+			}
+		}
+		InOutLineData.LineLength = LineLength;
+		return;
+	}
+
+	// Evaluation outside of the keys is clamped to the first and last key, or the first key again at the end of a looped curve, so
+	// there is nothing to sample there.
+	const float StartT = KeyPoints.Num() > 0 ? FMath::Max(LineDescriptor.InterpCurveStartT, KeyPoints[0].InVal) : 0.0f;
+	const float EndT = KeyPoints.Num() > 0 ? FMath::Min(LineDescriptor.InterpCurveEndT, FHermiteSegment::GetCurveEndT(LineDescriptor.InterpCurve)) : -1.0f;
+	if (StartT > EndT)
+	{
+		return;
+	}
+
+	const FCurveSamplingParams SamplingParams(LineDescriptor, AllottedGeometry, DrawScale);
+	TArray<float, TInlineAllocator<64>> EvalTValues;
+	auto& SamplePoints = InOutLineData.InterpCurveSamplePoints;
+	auto& IntervalSampleOffsets = InOutLineData.IntervalSampleOffsets;
+
+	int32 KeyIndex = FMath::Max(LineDescriptor.InterpCurve.GetPointIndexForInputValue(StartT), 0);
+	InOutLineData.FirstSampledKey = KeyIndex;
+	InOutLineData.SampledCurveSettings.DynamicResolutionScale = SamplingParams.DynamicResolutionScale;
+	InOutLineData.SampledCurveSettings.LocalTolerance = SamplingParams.LocalTolerance;
+	const int32 NumIntervals = FHermiteSegment::GetNumIntervals(LineDescriptor.InterpCurve);
+	for (float IntervalStartT = StartT; KeyIndex < NumIntervals && IntervalStartT < EndT; ++KeyIndex)
+	{
+		IntervalSampleOffsets.Add(SamplePoints.Num());
+		const float IntervalEndT = FMath::Min(FHermiteSegment::GetIntervalEndT(LineDescriptor.InterpCurve, KeyIndex), EndT);
+		if (IntervalEndT > IntervalStartT)
+		{
+			const FHermiteSegment Segment(LineDescriptor.InterpCurve, KeyIndex);
+			EvalTValues.Reset();
+			SampleKeyInterval(LineDescriptor, Segment, IntervalStartT, IntervalEndT, SamplingParams, EvalTValues);
+			const int32 FirstSampleIndex = SamplePoints.AddUninitialized(EvalTValues.Num());
+			Segment.EvalPoints(EvalTValues, SamplePoints.GetData() + FirstSampleIndex);
+			IntervalStartT = IntervalEndT;
+		}
+	}
+	IntervalSampleOffsets.Add(SamplePoints.Num());
+	SamplePoints.Add(LineDescriptor.InterpCurve.Eval(EndT));
+
+	for (const FVector2f& SamplePoint : SamplePoints)
+	{
+		InOutLineData.SampleBounds += SamplePoint;
+	}
+	InOutLineData.LineLength = GetPolylineLength(SamplePoints);
+}
+
+bool ILineDrawer::ReEvalDirtyKeyIntervals(FLineData& InOutLineData, const FGeometry& AllottedGeometry, float DrawScale)
+{
+	auto& LineDescriptor = InOutLineData.LineDescriptor;
+	auto& IntervalSampleOffsets = InOutLineData.IntervalSampleOffsets;
+	// Single key curves are cheaper to re-sample than to patch, and anything that changed how the curve is sampled invalidates the cached intervals.
+	if (InOutLineData.DirtyKeyBegin == INDEX_NONE || InOutLineData.FirstSampledKey == INDEX_NONE || IntervalSampleOffsets.Num() < 2)
+	{
+		return false;
+	}
+	const FCurveSamplingParams SamplingParams(LineDescriptor, AllottedGeometry, DrawScale);
+	if (SamplingParams.DynamicResolutionScale != InOutLineData.SampledCurveSettings.DynamicResolutionScale
+		|| SamplingParams.LocalTolerance != InOutLineData.SampledCurveSettings.LocalTolerance)
+	{
+		return false;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::ReEvalDirtyKeyIntervals);
+	FScopedLineDrawerCycles ScopedCycles(GLineDrawerFrameCounters.CurveEvaluationCycles);
+	GLineDrawerFrameCounters.NumReEvaluatedLines.fetch_add(1, std::memory_order_relaxed);
+
+	// Moving a key changes the interval ending at it and the one starting at it. The first key of a looped curve also ends the
+	// closing interval, at the other end of the samples, the curve is sampled again in full then.
+	if (LineDescriptor.InterpCurve.bIsLooped && InOutLineData.DirtyKeyBegin == 0)
+	{
+		return false;
+	}
+	const int32 NumIntervals = IntervalSampleOffsets.Num() - 1;
+	const int32 FirstInterval = FMath::Max(InOutLineData.DirtyKeyBegin - 1 - InOutLineData.FirstSampledKey, 0);
+	const int32 LastInterval = FMath::Min(InOutLineData.DirtyKeyEnd - InOutLineData.FirstSampledKey, NumIntervals - 1);
+	const TArray<FInterpCurvePoint<FVector2f>>& Keys = LineDescriptor.InterpCurve.Points;
+	FMemory::Memcpy(InOutLineData.SampledKeys.GetData() + InOutLineData.DirtyKeyBegin, Keys.GetData() + InOutLineData.DirtyKeyBegin,
+		(InOutLineData.DirtyKeyEnd + 1 - InOutLineData.DirtyKeyBegin) * sizeof(FInterpCurvePoint<FVector2f>));
+	InOutLineData.DirtyKeyBegin = InOutLineData.DirtyKeyEnd = INDEX_NONE;
+	InOutLineData.bNeedReEvalInterpCurve = false;
+	if (FirstInterval > LastInterval)
+	{
+		return true;
+	}
+
+	const auto& KeyPoints = LineDescriptor.InterpCurve.Points;
+	const float StartT = FMath::Max(LineDescriptor.InterpCurveStartT, KeyPoints[0].InVal);
+	const float EndT = FMath::Min(LineDescriptor.InterpCurveEndT, FHermiteSegment::GetCurveEndT(LineDescriptor.InterpCurve));
+	auto& SamplePoints = InOutLineData.InterpCurveSamplePoints;
+
+	// The span's length also covers the segment joining it to the previous sample, and ends at the first sample after it, which is
+	// either the unchanged start of the next interval or the final sample.
+	const int32 OldSpanBegin = IntervalSampleOffsets[FirstInterval];
+	const int32 OldSpanEnd = IntervalSampleOffsets[LastInterval + 1];
+	const int32 LengthBegin = FMath::Max(OldSpanBegin - 1, 0);
+	const float OldSpanLength = GetPolylineLength(TConstArrayView<FVector2f>(SamplePoints).Slice(LengthBegin, OldSpanEnd + 1 - LengthBegin));
+
+	TArray<FVector2f, TInlineAllocator<256>> NewSpanSamples;
+	TArray<float, TInlineAllocator<64>> EvalTValues;
+	for (int32 Interval = FirstInterval; Interval <= LastInterval; ++Interval)
+	{
+		IntervalSampleOffsets[Interval] = OldSpanBegin + NewSpanSamples.Num();
+		const int32 KeyIndex = InOutLineData.FirstSampledKey + Interval;
+		const float IntervalStartT = FMath::Max(KeyPoints[KeyIndex].InVal, StartT);
+		const float IntervalEndT = FMath::Min(FHermiteSegment::GetIntervalEndT(LineDescriptor.InterpCurve, KeyIndex), EndT);
+		if (IntervalEndT > IntervalStartT)
+		{
+			const FHermiteSegment Segment(LineDescriptor.InterpCurve, KeyIndex);
+			EvalTValues.Reset();
+			SampleKeyInterval(LineDescriptor, Segment, IntervalStartT, IntervalEndT, SamplingParams, EvalTValues);
+			const int32 FirstSampleIndex = NewSpanSamples.AddUninitialized(EvalTValues.Num());
+			Segment.EvalPoints(EvalTValues, NewSpanSamples.GetData() + FirstSampleIndex);
+		}
+	}
+
+	// Splice the new span in. Only the tail has to be shifted when the sample count changed, nothing outside the span is evaluated again.
+	const int32 SampleDelta = NewSpanSamples.Num() - (OldSpanEnd - OldSpanBegin);
+	if (SampleDelta > 0)
+	{
+		SamplePoints.InsertUninitialized(OldSpanEnd, SampleDelta);
+	}
+	else if (SampleDelta < 0)
+	{
+		SamplePoints.RemoveAt(OldSpanEnd + SampleDelta, -SampleDelta, EAllowShrinking::No);
+	}
+	if (SampleDelta != 0)
+	{
+		for (int32 Interval = LastInterval + 1; Interval <= NumIntervals; ++Interval)
+		{
+			IntervalSampleOffsets[Interval] += SampleDelta;
+		}
+	}
+	FMemory::Memcpy(SamplePoints.GetData() + OldSpanBegin, NewSpanSamples.GetData(), NewSpanSamples.Num() * sizeof(FVector2f));
+	if (LastInterval == NumIntervals - 1)
+	{
+		SamplePoints.Last() = LineDescriptor.InterpCurve.Eval(EndT);
+	}
+
+	const int32 NewSpanEnd = OldSpanEnd + SampleDelta;
+	const float NewSpanLength = GetPolylineLength(TConstArrayView<FVector2f>(SamplePoints).Slice(LengthBegin, NewSpanEnd + 1 - LengthBegin));
+	InOutLineData.LineLength = FMath::Max(InOutLineData.LineLength + NewSpanLength - OldSpanLength, 0.0f);
+
+	// Bounds only grow here, which keeps culling conservative until the next full evaluation.
+	for (int32 Index = OldSpanBegin; Index <= NewSpanEnd; ++Index)
+	{
+		InOutLineData.SampleBounds += SamplePoints[Index];
+	}
+	InOutLineData.DecimationDrawScale = 0.0f;
+	InOutLineData.SegmentChunkBounds.Reset();
+	InOutLineData.bNeedRebuildLocalGeometry = true;
+	InOutLineData.bNeedUpdateSpatialGrid = true;
+	return true;
+}
+
+TConstArrayView<FVector2f> ILineDrawer::GetLinePoints(const FLineData& LineData)
+{
+	if (LineData.Streaming)
+	{
+		return TConstArrayView<FVector2f>(LineData.Streaming->Points).RightChop(LineData.Streaming->HeadPoint);
+	}
+	if (LineData.LineDescriptor.IsPolyline())
+	{
+		return *LineData.LineDescriptor.PolylinePoints;
+	}
+	return LineData.InterpCurveSamplePoints;
+}
+
+TConstArrayView<FBox2f> ILineDrawer::GetSegmentChunkBounds(FLineData& InOutLineData)
+{
+	const TConstArrayView<FVector2f> Points = GetLinePoints(InOutLineData);
+	const int32 NumChunks = Points.Num() > 1 ? FMath::DivideAndRoundUp(Points.Num() - 1, HitTestChunkSegments) : 0;
+	TArray<FBox2f>& ChunkBounds = InOutLineData.SegmentChunkBounds;
+	if (ChunkBounds.Num() != NumChunks)
+	{
+		ChunkBounds.SetNumUninitialized(NumChunks);
+		for (int32 Chunk = 0; Chunk < NumChunks; ++Chunk)
+		{
+			FBox2f Bounds(ForceInit);
+			const int32 EndPoint = FMath::Min((Chunk + 1) * HitTestChunkSegments, Points.Num() - 1);
+			for (int32 Point = Chunk * HitTestChunkSegments; Point <= EndPoint; ++Point)
+			{
+				Bounds += Points[Point];
+			}
+			ChunkBounds[Chunk] = Bounds;
+		}
+	}
+	return ChunkBounds;
+}
+
+float ILineDrawer::GetLineHitT(const FLineData& LineData, int32 SegmentIndex, float SegmentAlpha)
+{
+	const FLineDescriptor& LineDescriptor = LineData.LineDescriptor;
+	const TArray<FInterpCurvePoint<FVector2f>>& KeyPoints = LineDescriptor.InterpCurve.Points;
+	const TArray<int32>& IntervalSampleOffsets = LineData.IntervalSampleOffsets;
+	if (LineData.Streaming || LineDescriptor.IsPolyline() || LineData.FirstSampledKey == INDEX_NONE || IntervalSampleOffsets.Num() < 2)
+	{
+		return SegmentIndex + SegmentAlpha;
+	}
+
+	// The T of the samples isn't kept, but they are spread over their key interval, so the hit is placed in it by sample count.
+	const int32 Interval = FMath::Clamp(Algo::UpperBound(IntervalSampleOffsets, SegmentIndex) - 1, 0, IntervalSampleOffsets.Num() - 2);
+	const int32 KeyIndex = LineData.FirstSampledKey + Interval;
+	if (KeyIndex >= FHermiteSegment::GetNumIntervals(LineDescriptor.InterpCurve))
+	{
+		return SegmentIndex + SegmentAlpha;
+	}
+
+	const float IntervalStartT = FMath::Max(KeyPoints[KeyIndex].InVal, LineDescriptor.InterpCurveStartT);
+	const float IntervalEndT = FMath::Min(FHermiteSegment::GetIntervalEndT(LineDescriptor.InterpCurve, KeyIndex), LineDescriptor.InterpCurveEndT);
+	if (KeyPoints[KeyIndex].InterpMode == CIM_Constant)
+	{
+		// A held key only draws the jump to the next key, which the curve makes at the next key.
+		return SegmentIndex > IntervalSampleOffsets[Interval] ? IntervalEndT : IntervalStartT;
+	}
+	const int32 NumIntervalSegments = FMath::Max(IntervalSampleOffsets[Interval + 1] - IntervalSampleOffsets[Interval], 1);
+	const float IntervalAlpha = (SegmentIndex - IntervalSampleOffsets[Interval] + SegmentAlpha) / NumIntervalSegments;
+	return FMath::Lerp(IntervalStartT, IntervalEndT, FMath::Clamp(IntervalAlpha, 0.0f, 1.0f));
+}
+
+bool ILineDrawer::SegmentIntersectsBox(const FVector2f& SegmentStart, const FVector2f& SegmentEnd, const FBox2f& Box)
+{
+	// Liang-Barsky, clips the segment against the slab of each axis.
+	const FVector2f Delta = SegmentEnd - SegmentStart;
+	float EnterAlpha = 0.0f;
+	float ExitAlpha = 1.0f;
+	for (int32 Axis = 0; Axis < 2; ++Axis)
+	{
+		if (Delta[Axis] == 0.0f)
+		{
+			if (SegmentStart[Axis] < Box.Min[Axis] || SegmentStart[Axis] > Box.Max[Axis])
+			{
+				return false;
+			}
+			continue;
+		}
+
+		float SlabEnterAlpha = (Box.Min[Axis] - SegmentStart[Axis]) / Delta[Axis];
+		float SlabExitAlpha = (Box.Max[Axis] - SegmentStart[Axis]) / Delta[Axis];
+		if (SlabEnterAlpha > SlabExitAlpha)
+		{
+			Swap(SlabEnterAlpha, SlabExitAlpha);
+		}
+		EnterAlpha = FMath::Max(EnterAlpha, SlabEnterAlpha);
+		ExitAlpha = FMath::Min(ExitAlpha, SlabExitAlpha);
+		if (EnterAlpha > ExitAlpha)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+float ILineDrawer::GetPolylineLength(TConstArrayView<FVector2f> Points)
+{
+	float Length = 0.0f;
+	for (int32 Index = 1; Index < Points.Num(); ++Index)
+	{
+		Length += (Points[Index] - Points[Index - 1]).Size();
+	}
+	return Length;
+}
+
+ILineDrawer::FCurveSamplingParams::FCurveSamplingParams(const FLineDescriptor& LineDescriptor, const FGeometry& AllottedGeometry, float DrawScale) :
+	DynamicResolutionScale(LineDescriptor.DynamicResolutionFactor * AllottedGeometry.GetLocalSize().Length()),
+	LocalTolerance(FMath::Max(LineDescriptor.TessellationTolerance, KINDA_SMALL_NUMBER) / FMath::Max(DrawScale, KINDA_SMALL_NUMBER))
+{
+	check(DynamicResolutionScale >= 0);
+	check(LineDescriptor.Resolution > 0);
+}
+
+void ILineDrawer::SampleKeyInterval(const FLineDescriptor& LineDescriptor, const FHermiteSegment& Segment, float IntervalStartT, float IntervalEndT, const FCurveSamplingParams& SamplingParams, TArray<float, TInlineAllocator<64>>& OutEvalTValues)
+{
+	if (Segment.InterpMode == CIM_Constant)
+	{
+		// The key value is held up to the next key, where the next sample steps to the value of that key. An interval cut short by
+		// InterpCurveEndT already ends on the held value with the final sample.
+		OutEvalTValues.Add(IntervalStartT);
+		if (IntervalEndT == Segment.EndT)
+		{
+			OutEvalTValues.Add(IntervalEndT);
+		}
+		return;
+	}
+
+	if (!Segment.IsCurve())
+	{
+		OutEvalTValues.Add(IntervalStartT);
+		return;
+	}
+
+	if (LineDescriptor.TessellationMode == ELineTessellationMode::ScreenSpaceTolerance)
+	{
+		const FVector2f StartPoint = Segment.Eval(IntervalStartT);
+		const FVector2f StartTangent = Segment.EvalDerivative(IntervalStartT);
+		const FVector2f EndPoint = Segment.Eval(IntervalEndT);
+		const FVector2f EndTangent = Segment.EvalDerivative(IntervalEndT);
+		SubdivideKeyInterval(Segment, IntervalStartT, StartPoint, StartTangent, IntervalEndT, EndPoint, EndTangent, SamplingParams.LocalTolerance * SamplingParams.LocalTolerance, 0, OutEvalTValues);
+		return;
+	}
+
+	float EvalT = IntervalStartT;
+	do
+	{
+		OutEvalTValues.Add(EvalT);
+		const float SecondDerivativeSq = Segment.EvalSecondDerivative(EvalT).SquaredLength();
+		const float DynamicResolution = SamplingParams.DynamicResolutionScale * SecondDerivativeSq / DynamicResolutionUnitCube;
+		const float Resolution = FMath::Min(LineDescriptor.Resolution + DynamicResolution, LineDescriptor.MaxResolution);
+		EvalT = EvalT + 1.0f / Resolution;
+	}
+	while (EvalT < IntervalEndT);
+}
+
+void ILineDrawer::SubdivideKeyInterval(const FHermiteSegment& Segment, float StartT, const FVector2f& StartPoint, const FVector2f& StartTangent, float EndT, const FVector2f& EndPoint, const FVector2f& EndTangent, float LocalToleranceSq, int32 Depth, TArray<float, TInlineAllocator<64>>& OutEvalTValues)
+{
+	// The span is a cubic whose Bezier control points bound it, so the farthest control point from the chord bounds the chord error.
+	const float DeltaT = EndT - StartT;
+	const FVector2f StartControlPoint = StartPoint + StartTangent * (DeltaT / 3.0f);
+	const FVector2f EndControlPoint = EndPoint - EndTangent * (DeltaT / 3.0f);
+	const float ChordErrorSq = FMath::Max(GetPointSegmentDistanceSq(StartControlPoint, StartPoint, EndPoint), GetPointSegmentDistanceSq(EndControlPoint, StartPoint, EndPoint));
+
+	if (ChordErrorSq <= LocalToleranceSq || Depth >= MaxSubdivisionDepth)
+	{
+		OutEvalTValues.Add(StartT);
+		return;
+	}
+
+	const float MidT = StartT + DeltaT * 0.5f;
+	const FVector2f MidPoint = Segment.Eval(MidT);
+	const FVector2f MidTangent = Segment.EvalDerivative(MidT);
+	SubdivideKeyInterval(Segment, StartT, StartPoint, StartTangent, MidT, MidPoint, MidTangent, LocalToleranceSq, Depth + 1, OutEvalTValues);
+	SubdivideKeyInterval(Segment, MidT, MidPoint, MidTangent, EndT, EndPoint, EndTangent, LocalToleranceSq, Depth + 1, OutEvalTValues);
+}
+
+ILineDrawer::FHermiteSegment::FHermiteSegment(const FInterpCurve<FVector2f>& InterpCurve, int32 KeyIndex)
+{
+	const auto& KeyPoints = InterpCurve.Points;
+	check(KeyPoints.IsValidIndex(KeyIndex));
+
+	// Mirrors FInterpCurve::Eval: the last key of a curve that isn't looped, zero length intervals and constant keys all hold the
+	// key value.
+	const auto& StartKey = KeyPoints[KeyIndex];
+	StartT = EndT = StartKey.InVal;
+	D = StartKey.OutVal;
+	InterpMode = CIM_Constant;
+	if (KeyIndex >= GetNumIntervals(InterpCurve))
+	{
+		return;
+	}
+
+	const bool bLoopInterval = KeyIndex == KeyPoints.Num() - 1;
+	const auto& EndKey = KeyPoints[bLoopInterval ? 0 : KeyIndex + 1];
+	EndT = GetIntervalEndT(InterpCurve, KeyIndex);
+	const float DeltaT = bLoopInterval ? InterpCurve.LoopKeyOffset : EndKey.InVal - StartKey.InVal;
+	if (DeltaT <= 0.0f || StartKey.InterpMode == CIM_Constant)
+	{
+		return;
+	}
+
+	InvDeltaT = 1.0f / DeltaT;
+	if (StartKey.InterpMode == CIM_Linear)
+	{
+		InterpMode = CIM_Linear;
+		C = EndKey.OutVal - StartKey.OutVal;
+		return;
+	}
+
+	// Coefficients of FMath::CubicInterp expanded to a polynomial in the interval's alpha.
+	InterpMode = CIM_CurveUser;
+	const FVector2f StartTangent = StartKey.LeaveTangent * DeltaT;
+	const FVector2f EndTangent = EndKey.ArriveTangent * DeltaT;
+	A = 2.0f * StartKey.OutVal + StartTangent + EndTangent - 2.0f * EndKey.OutVal;
+	B = 3.0f * EndKey.OutVal - 3.0f * StartKey.OutVal - 2.0f * StartTangent - EndTangent;
+	C = StartTangent;
+}
+
+int32 ILineDrawer::FHermiteSegment::GetNumIntervals(const FInterpCurve<FVector2f>& InterpCurve)
+{
+	return InterpCurve.bIsLooped ? InterpCurve.Points.Num() : InterpCurve.Points.Num() - 1;
+}
+
+float ILineDrawer::FHermiteSegment::GetIntervalEndT(const FInterpCurve<FVector2f>& InterpCurve, int32 KeyIndex)
+{
+	const auto& KeyPoints = InterpCurve.Points;
+	if (KeyIndex < KeyPoints.Num() - 1)
+	{
+		return KeyPoints[KeyIndex + 1].InVal;
+	}
+	return InterpCurve.bIsLooped ? KeyPoints[KeyIndex].InVal + InterpCurve.LoopKeyOffset : KeyPoints[KeyIndex].InVal;
+}
+
+FVector2f ILineDrawer::FHermiteSegment::Eval(float T) const
+{
+	const float Alpha = (T - StartT) * InvDeltaT;
+	return ((A * Alpha + B) * Alpha + C) * Alpha + D;
+}
+
+FVector2f ILineDrawer::FHermiteSegment::EvalDerivative(float T) const
+{
+	const float Alpha = (T - StartT) * InvDeltaT;
+	return ((3.0f * A * Alpha + 2.0f * B) * Alpha + C) * InvDeltaT;
+}
+
+FVector2f ILineDrawer::FHermiteSegment::EvalSecondDerivative(float T) const
+{
+	const float Alpha = (T - StartT) * InvDeltaT;
+	return (6.0f * A * Alpha + 2.0f * B) * (InvDeltaT * InvDeltaT);
+}
+
+void ILineDrawer::FHermiteSegment::EvalPoints(TConstArrayView<float> EvalTValues, FVector2f* OutPoints) const
+{
+	const int32 NumPoints = EvalTValues.Num();
+	const float* TValues = EvalTValues.GetData();
+
+	if (InterpMode == CIM_Constant)
+	{
+		for (int32 Index = 0; Index < NumPoints; ++Index)
+		{
+			OutPoints[Index] = D;
+		}
+		return;
+	}
+
+	if (InterpMode == CIM_Linear)
+	{
+		for (int32 Index = 0; Index < NumPoints; ++Index)
+		{
+			OutPoints[Index] = C * ((TValues[Index] - StartT) * InvDeltaT) + D;
+		}
+		return;
+	}
+
+	const VectorRegister4Float VecStartT = VectorSetFloat1(StartT);
+	const VectorRegister4Float VecInvDeltaT = VectorSetFloat1(InvDeltaT);
+	const VectorRegister4Float VecAX = VectorSetFloat1(A.X), VecAY = VectorSetFloat1(A.Y);
+	const VectorRegister4Float VecBX = VectorSetFloat1(B.X), VecBY = VectorSetFloat1(B.Y);
+	const VectorRegister4Float VecCX = VectorSetFloat1(C.X), VecCY = VectorSetFloat1(C.Y);
+	const VectorRegister4Float VecDX = VectorSetFloat1(D.X), VecDY = VectorSetFloat1(D.Y);
+
+	int32 Index = 0;
+	for (; Index + 4 <= NumPoints; Index += 4)
+	{
+		const VectorRegister4Float Alpha = VectorMultiply(VectorSubtract(VectorLoad(TValues + Index), VecStartT), VecInvDeltaT);
+		const VectorRegister4Float X = VectorMultiplyAdd(VectorMultiplyAdd(VectorMultiplyAdd(VecAX, Alpha, VecBX), Alpha, VecCX), Alpha, VecDX);
+		const VectorRegister4Float Y = VectorMultiplyAdd(VectorMultiplyAdd(VectorMultiplyAdd(VecAY, Alpha, VecBY), Alpha, VecCY), Alpha, VecDY);
+
+		alignas(16) float PointX[4];
+		alignas(16) float PointY[4];
+		VectorStoreAligned(X, PointX);
+		VectorStoreAligned(Y, PointY);
+		for (int32 Lane = 0; Lane < 4; ++Lane)
+		{
+			OutPoints[Index + Lane] = FVector2f(PointX[Lane], PointY[Lane]);
+		}
+	}
+
+	for (; Index < NumPoints; ++Index)
+	{
+		OutPoints[Index] = Eval(TValues[Index]);
+	}
+}
+
+float ILineDrawer::GetPointSegmentDistanceSq(const FVector2f& Point, const FVector2f& SegmentStart, const FVector2f& SegmentEnd)
+{
+	const FVector2f Segment = SegmentEnd - SegmentStart;
+	const float SegmentLengthSq = Segment.SizeSquared();
+	const float Alpha = SegmentLengthSq > SMALL_NUMBER ? FMath::Clamp(FVector2f::DotProduct(Point - SegmentStart, Segment) / SegmentLengthSq, 0.0f, 1.0f) : 0.0f;
+	return FVector2f::DistSquared(Point, SegmentStart + Segment * Alpha);
+}
+
+bool ILineDrawer::NeedReEvalForDrawScale(const FLineData& LineData, float DrawScale)
+{
+	if (LineData.LineDescriptor.TessellationMode != ELineTessellationMode::ScreenSpaceTolerance || LineData.SampleDrawScale <= 0.0f || LineData.LineDescriptor.IsPolyline() || LineData.Streaming)
+	{
+		return false;
+	}
+
+	// Halving the tolerance in local space is the first point where the extra samples become worth the re-evaluation.
+	constexpr float MaxDrawScaleRatio = 2.0f;
+	const float DrawScaleRatio = DrawScale / LineData.SampleDrawScale;
+	return DrawScaleRatio > MaxDrawScaleRatio || DrawScaleRatio < 1.0f / MaxDrawScaleRatio;
+}
+
+ILineDrawer::ERenderDataUpdate ILineDrawer::UpdateLineRenderData(FLineData& InOutLineData, const FGeometry& AllottedGeometry, const FSlateRenderTransform& RenderTransform, float DrawScale, bool bDeferRebuild)
+{
+	if (bDeferRebuild)
+	{
+		// Keep transforming the last finished geometry, the rebuild for the new DrawScale is picked up by the next tessellation job.
+		if (!InOutLineData.bTessellationInFlight && (NeedReEvalForDrawScale(InOutLineData, DrawScale) || NeedRebuildLocalGeometry(InOutLineData, DrawScale)))
+		{
+			InOutLineData.bNeedRebuildLocalGeometry = true;
+		}
+	}
+	else if (NeedReEvalForDrawScale(InOutLineData, DrawScale))
+	{
+		EvalLineInterpCurve(InOutLineData, AllottedGeometry, DrawScale);
+	}
+
+	if (bDeferRebuild || (!InOutLineData.bNeedRebuildLocalGeometry && !NeedRebuildLocalGeometry(InOutLineData, DrawScale)))
+	{
+		if (InOutLineData.RenderDataTransform == RenderTransform)
+		{
+			return ERenderDataUpdate::None;
+		}
+
+		TransformRenderData(InOutLineData.RenderData, RenderTransform, ESlateVertexRounding::Enabled);
+		InOutLineData.RenderDataTransform = RenderTransform;
+		return ERenderDataUpdate::Transformed;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::UpdateLineRenderData);
+
+	BuildLocalGeometry(InOutLineData, DrawScale);
+	TransformRenderData(InOutLineData.RenderData, RenderTransform, ESlateVertexRounding::Enabled);
+	InOutLineData.RenderDataTransform = RenderTransform;
+	return ERenderDataUpdate::Rebuilt;
+}
+
+void ILineDrawer::TessellateLine(FLineData& InOutLineData, const FGeometry& AllottedGeometry, float DrawScale)
+{
+	if (InOutLineData.bNeedReEvalInterpCurve || NeedReEvalForDrawScale(InOutLineData, DrawScale))
+	{
+		if (!ReEvalDirtyKeyIntervals(InOutLineData, AllottedGeometry, DrawScale))
+		{
+			EvalLineInterpCurve(InOutLineData, AllottedGeometry, DrawScale);
+		}
+	}
+	BuildLocalGeometry(InOutLineData, DrawScale);
+}
+
+void ILineDrawer::BuildLocalGeometry(FLineData& InOutLineData, float DrawScale)
+{
+	BuildLocalGeometry(InOutLineData, DrawScale, GetLinePoints(InOutLineData), InOutLineData.LineLength);
+}
+
+void ILineDrawer::BuildLocalGeometry(FLineData& InOutLineData, float DrawScale, TConstArrayView<FVector2f> LinePoints, float LineLength)
+{
+	FScopedLineDrawerCycles ScopedCycles(GLineDrawerFrameCounters.GeometryBuildingCycles);
+	GLineDrawerFrameCounters.NumRetriangulatedLines.fetch_add(1, std::memory_order_relaxed);
+
+	const auto& LineDescriptor = InOutLineData.LineDescriptor;
+	auto& RenderData = InOutLineData.RenderData;
+	RenderData.LocalPositionX.Reset();
+	RenderData.LocalPositionY.Reset();
+	RenderData.VertexData.Reset();
+	RenderData.IndexData.Reset();
+	InOutLineData.bNeedRebuildLocalGeometry = false;
+	InOutLineData.LocalGeometryDrawScale = DrawScale;
+	InOutLineData.GeometryThickness = LineDescriptor.Thickness;
+	RenderData.VertexColor = GetLineVertexColor(LineDescriptor);
+	const bool bDecimationChanged = !IsSameDecimation(InOutLineData, LineDescriptor);
+	SetDecimation(InOutLineData, LineDescriptor);
+
+	if (InOutLineData.Streaming)
+	{
+		BuildStreamingGeometry(InOutLineData, DrawScale);
+		return;
+	}
+
+	if (LinePoints.Num() < 2 || LineLength <= KINDA_SMALL_NUMBER)
+	{
+		return;
+	}
+
+	if (LineDescriptor.Decimation != ELineDecimationMode::None && LinePoints.Num() >= GLineDrawerDecimationMinPoints)
+	{
+		if (bDecimationChanged || NeedDecimateForDrawScale(InOutLineData, DrawScale))
+		{
+			DecimateLinePoints(LinePoints, LineDescriptor, DrawScale, InOutLineData.DecimatedPoints);
+			InOutLineData.DecimationDrawScale = DrawScale;
+			GLineDrawerFrameCounters.NumDecimatedPoints.fetch_add(LinePoints.Num() - InOutLineData.DecimatedPoints.Num(), std::memory_order_relaxed);
+		}
+		// U still spans the line, the decimated path is shorter than the one sampled.
+		LinePoints = InOutLineData.DecimatedPoints;
+		LineLength = FMath::Max(GetPolylineLength(LinePoints), KINDA_SMALL_NUMBER);
+	}
+	else if (InOutLineData.DecimatedPoints.Num() > 0)
+	{
+		InOutLineData.DecimatedPoints.Empty();
+		InOutLineData.DecimationDrawScale = 0.0f;
+	}
+
+	FLineBuilder LineBuilder(RenderData, DrawScale, LineDescriptor.Thickness, LineAntiAliasingFilterRadius, LineMiterAngleLimit);
+	LineBuilder.BuildLineGeometry(LinePoints, LineLength, RenderData.VertexColor);
+}
+
+bool ILineDrawer::IsSameDecimation(const FLineData& LineData, const FLineDescriptor& LineDescriptor)
+{
+	return LineData.Decimation == LineDescriptor.Decimation
+		&& (LineDescriptor.Decimation != ELineDecimationMode::Tolerance || LineData.DecimationTolerance == LineDescriptor.DecimationTolerance);
+}
+
+void ILineDrawer::SetDecimation(FLineData& InOutLineData, const FLineDescriptor& LineDescriptor)
+{
+	InOutLineData.Decimation = LineDescriptor.Decimation;
+	InOutLineData.DecimationTolerance = LineDescriptor.DecimationTolerance;
+}
+
+bool ILineDrawer::NeedDecimateForDrawScale(const FLineData& LineData, float DrawScale)
+{
+	if (LineData.DecimationDrawScale <= 0.0f)
+	{
+		return true;
+	}
+
+	// Pixel columns and the tolerance are in local space, a quarter of a pixel of drift is about where the dropped points start to show.
+	constexpr float MaxDrawScaleRatio = 1.25f;
+	const float DrawScaleRatio = DrawScale / LineData.DecimationDrawScale;
+	return DrawScaleRatio > MaxDrawScaleRatio || DrawScaleRatio < 1.0f / MaxDrawScaleRatio;
+}
+
+void ILineDrawer::DecimateLinePoints(TConstArrayView<FVector2f> Points, const FLineDescriptor& LineDescriptor, float DrawScale, TArray<FVector2f>& OutPoints)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::DecimateLinePoints);
+
+	OutPoints.Reset();
+	const float ColumnsPerUnit = FMath::Max(DrawScale, SMALL_NUMBER);
+	const float LocalTolerance = FMath::Max(LineDescriptor.DecimationTolerance, 0.0f) / ColumnsPerUnit;
+	auto DecimateChunk = [&LineDescriptor, ColumnsPerUnit, LocalTolerance](TConstArrayView<FVector2f> ChunkPoints, TArray<FVector2f>& OutChunkPoints)
+	{
+		if (LineDescriptor.Decimation == ELineDecimationMode::MinMaxPerPixel)
+		{
+			DecimateMinMaxPerPixel(ChunkPoints, ColumnsPerUnit, OutChunkPoints);
+		}
+		else
+		{
+			DecimateDouglasPeucker(ChunkPoints, FMath::Square(LocalTolerance), OutChunkPoints);
+		}
+	};
+
+	const int32 ChunkSize = FMath::Max(GLineDrawerDecimationChunkSize, 2);
+	const int32 NumChunks = FMath::DivideAndRoundUp(Points.Num() - 1, ChunkSize);
+	if (NumChunks <= 1 || GLineDrawerForceSingleThread)
+	{
+		DecimateChunk(Points, OutPoints);
+		return;
+	}
+
+	// The chunks share their end points, which are always kept, so they stitch back together. A pixel column split across two
+	// chunks keeps up to eight points instead of four.
+	TArray<TArray<FVector2f>> ChunkOutPoints;
+	ChunkOutPoints.SetNum(NumChunks);
+	ParallelFor(TEXT("ILineDrawer::ParallelDecimateLinePoints"), NumChunks, 1, [&Points, &ChunkOutPoints, &DecimateChunk, ChunkSize](int32 ChunkIndex)
+	{
+		LLM_SCOPE_BYTAG(LineDrawer);
+		const int32 ChunkStart = ChunkIndex * ChunkSize;
+		const int32 ChunkEnd = FMath::Min(ChunkStart + ChunkSize, Points.Num() - 1);
+		DecimateChunk(Points.Slice(ChunkStart, ChunkEnd + 1 - ChunkStart), ChunkOutPoints[ChunkIndex]);
+	});
+
+	int32 NumOutPoints = 1;
+	for (const TArray<FVector2f>& ChunkPoints : ChunkOutPoints)
+	{
+		NumOutPoints += ChunkPoints.Num() - 1;
+	}
+	OutPoints.Reserve(NumOutPoints);
+	OutPoints.Add(Points[0]);
+	for (const TArray<FVector2f>& ChunkPoints : ChunkOutPoints)
+	{
+		OutPoints.Append(TConstArrayView<FVector2f>(ChunkPoints).RightChop(1));
+	}
+}
+
+void ILineDrawer::DecimateMinMaxPerPixel(TConstArrayView<FVector2f> Points, float ColumnsPerUnit, TArray<FVector2f>& OutPoints)
+{
+	// A run of points in one pixel column rasterizes the same as its first, lowest, highest and last points in their original order.
+	for (int32 RunStart = 0; RunStart < Points.Num();)
+	{
+		const int64 Column = FMath::FloorToInt64(Points[RunStart].X * ColumnsPerUnit);
+		int32 MinIndex = RunStart;
+		int32 MaxIndex = RunStart;
+		int32 RunEnd = RunStart + 1;
+		for (; RunEnd < Points.Num() && FMath::FloorToInt64(Points[RunEnd].X * ColumnsPerUnit) == Column; ++RunEnd)
+		{
+			MinIndex = Points[RunEnd].Y < Points[MinIndex].Y ? RunEnd : MinIndex;
+			MaxIndex = Points[RunEnd].Y > Points[MaxIndex].Y ? RunEnd : MaxIndex;
+		}
+
+		const int32 FirstExtreme = FMath::Min(MinIndex, MaxIndex);
+		const int32 SecondExtreme = FMath::Max(MinIndex, MaxIndex);
+		const int32 RunLast = RunEnd - 1;
+		OutPoints.Add(Points[RunStart]);
+		if (FirstExtreme != RunStart)
+		{
+			OutPoints.Add(Points[FirstExtreme]);
+		}
+		if (SecondExtreme != FirstExtreme)
+		{
+			OutPoints.Add(Points[SecondExtreme]);
+		}
+		if (RunLast != SecondExtreme)
+		{
+			OutPoints.Add(Points[RunLast]);
+		}
+		RunStart = RunEnd;
+	}
+}
+
+void ILineDrawer::DecimateDouglasPeucker(TConstArrayView<FVector2f> Points, float ToleranceSq, TArray<FVector2f>& OutPoints)
 {
 	const int32 NumPoints = Points.Num();
-	InterpCurve.Points.SetNumUninitialized(NumPoints);
-	FVector2f NextArriveTangent = FVector2f::Zero();
-	for (int32 Index = 0; Index < NumPoints; ++Index)
+	if (NumPoints <= 2)
 	{
-		const FVector2f& CurrentPoint = Points[Index];
-		const float InterpT = FMath::Lerp(InterpStartT, InterpEndT, NumPoints > 1 ? static_cast<float>(Index) / (NumPoints - 1) : 1.0f);
+		OutPoints.Append(Points);
+		return;
+	}
 
-		if (Index < NumPoints - 1)
+	TBitArray<> KeptPoints(false, NumPoints);
+	KeptPoints[0] = KeptPoints[NumPoints - 1] = true;
+	TArray<TPair<int32, int32>, TInlineAllocator<64>> Spans;
+	Spans.Emplace(0, NumPoints - 1);
+	while (Spans.Num() > 0)
+	{
+		const TPair<int32, int32> Span = Spans.Pop(EAllowShrinking::No);
+		float MaxDistanceSq = ToleranceSq;
+		int32 SplitIndex = INDEX_NONE;
+		for (int32 Index = Span.Key + 1; Index < Span.Value; ++Index)
 		{
-			const FVector2f DeltaPos = Points[Index + 1] - CurrentPoint;
-			if (InterpMode == CIM_Linear)
+			const float DistanceSq = GetPointSegmentDistanceSq(Points[Index], Points[Span.Key], Points[Span.Value]);
+			if (DistanceSq > MaxDistanceSq)
 			{
-				InterpCurve.Points[Index] = FInterpCurvePoint(InterpT, CurrentPoint, NextArriveTangent, DeltaPos, InterpMode);
-				NextArriveTangent = -DeltaPos;
-				continue;
+				MaxDistanceSq = DistanceSq;
+				SplitIndex = Index;
 			}
-			const float ClampedTensionX = FMath::Min<float>(FMath::Abs<float>(DeltaPos.X), TangentSettings.SplineHorizontalDeltaRange);
-			const float ClampedTensionY = FMath::Min<float>(FMath::Abs<float>(DeltaPos.Y), TangentSettings.SplineVerticalDeltaRange);
-			const FVector2f SplineTangent = (ClampedTensionX * TangentSettings.SplineTangentFromHorizontalDelta + ClampedTensionY * TangentSettings.SplineTangentFromVerticalDelta) * FVector2f(FMath::Sign(DeltaPos.X), FMath::Sign(DeltaPos.Y));
-
-			InterpCurve.Points[Index] = FInterpCurvePoint(InterpT, CurrentPoint, NextArriveTangent, SplineTangent, InterpMode);
-			NextArriveTangent = TangentSettings.bTranspose ? FVector2f(-SplineTangent.Y, DeltaPos.X > 0 ? SplineTangent.X : -SplineTangent.X) : FVector2f(SplineTangent.X, -SplineTangent.Y);
 		}
-		else
+
+		if (SplitIndex != INDEX_NONE)
 		{
-			InterpCurve.Points[Index] = FInterpCurvePoint(InterpT, CurrentPoint, NextArriveTangent, FVector2f::Zero(), InterpMode);
+			KeptPoints[SplitIndex] = true;
+			Spans.Emplace(Span.Key, SplitIndex);
+			Spans.Emplace(SplitIndex, Span.Value);
 		}
 	}
+
+	for (TConstSetBitIterator<> It(KeptPoints); It; ++It)
+	{
+		OutPoints.Add(Points[It.GetIndex()]);
+	}
 }
 
-int32 FLineDescriptor::AddPoint(const FVector2f& Point, float InterpT, EInterpCurveMode InterpMode, const FVector2f& ArriveTangent, const FVector2f& LeaveTangent)
+void ILineDrawer::BuildStreamingGeometry(FLineData& InOutLineData, float DrawScale)
 {
-	const int32 NewCurvePointIndex = InterpCurve.AddPoint(InterpT, Point);
-	auto& NewCurvePoint = InterpCurve.Points[NewCurvePointIndex];
+	FStreamingLine& Stream = *InOutLineData.Streaming;
+	Stream.HeadPoint = FMath::Max(Stream.HeadPoint, Stream.Points.Num() - Stream.Capacity);
+	Stream.NumBuiltPoints = Stream.TailVertex = Stream.TailIndex = Stream.NumDeadVertices = Stream.NumDeadIndices = 0;
+	CompactStreamingLine(InOutLineData, true);
+	InOutLineData.LineLength = Stream.Points.Num() > 0 ? Stream.ArcLengths.Last() - Stream.ArcLengths[0] : 0.0f;
 
-	NewCurvePoint.InterpMode = InterpMode;
-	NewCurvePoint.ArriveTangent = ArriveTangent;
-	NewCurvePoint.LeaveTangent = LeaveTangent;
+	FLineBuilder LineBuilder(InOutLineData.RenderData, DrawScale, InOutLineData.GeometryThickness, LineAntiAliasingFilterRadius, LineMiterAngleLimit);
+	LineBuilder.BuildStreamingGeometry(Stream, InOutLineData.RenderData.VertexColor);
+}
 
-	return NewCurvePointIndex;
+void ILineDrawer::ExtendStreamingGeometry(FLineData& InOutLineData, int32& OutFirstNewVertex, int32& OutHeadCapVertex)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::ExtendStreamingGeometry);
+	FScopedLineDrawerCycles ScopedCycles(GLineDrawerFrameCounters.GeometryBuildingCycles);
+
+	FStreamingLine& Stream = *InOutLineData.Streaming;
+	FRenderData& RenderData = InOutLineData.RenderData;
+	OutHeadCapVertex = INDEX_NONE;
+	CompactStreamingLine(InOutLineData, false);
+
+	const int32 NewHeadPoint = FMath::Max(Stream.HeadPoint, Stream.Points.Num() - Stream.Capacity);
+	if (NewHeadPoint > Stream.HeadPoint)
+	{
+		if (NewHeadPoint < Stream.NumBuiltPoints - 1)
+		{
+			TrimStreamingHead(InOutLineData, NewHeadPoint, OutHeadCapVertex);
+		}
+		else
+		{
+			// Everything built so far scrolled out.
+			RenderData.LocalPositionX.Reset();
+			RenderData.LocalPositionY.Reset();
+			RenderData.VertexData.Reset();
+			RenderData.IndexData.Reset();
+			Stream.HeadPoint = NewHeadPoint;
+			Stream.NumBuiltPoints = Stream.TailVertex = Stream.TailIndex = Stream.NumDeadVertices = Stream.NumDeadIndices = 0;
+		}
+		InOutLineData.LineLength = Stream.ArcLengths.Last() - Stream.ArcLengths[Stream.HeadPoint];
+	}
+
+	OutFirstNewVertex = Stream.NumBuiltPoints - Stream.HeadPoint < 2 ? RenderData.VertexData.Num() : Stream.TailVertex;
+	FLineBuilder LineBuilder(RenderData, InOutLineData.LocalGeometryDrawScale, InOutLineData.GeometryThickness, LineAntiAliasingFilterRadius, LineMiterAngleLimit);
+	LineBuilder.BuildStreamingGeometry(Stream, RenderData.VertexColor);
 }
 
-int32 ILineDrawer::AddLine(const FLineDescriptor& LineDescriptor)
+void ILineDrawer::TrimStreamingHead(FLineData& InOutLineData, int32 NewHeadPoint, int32& OutHeadCapVertex)
 {
-	FLineData NewLineData;
-	NewLineData.LineDescriptor = LineDescriptor;
-	NewLineData.bNeedReEvalInterpCurve = true;
+	FStreamingLine& Stream = *InOutLineData.Streaming;
+	FRenderData& RenderData = InOutLineData.RenderData;
+	const int32 OldNumDeadIndices = Stream.NumDeadIndices;
+	if (Stream.MiterJoins[NewHeadPoint])
+	{
+		// The two vertices before the miter and the quad joining them to it have the layout of a start cap, so rewriting those
+		// four vertices caps the new head without moving anything else.
+		const int32 CapVertex = Stream.FirstVertices[NewHeadPoint] - 2;
+		FRenderData CapRenderData;
+		FLineBuilder CapBuilder(CapRenderData, InOutLineData.LocalGeometryDrawScale, InOutLineData.GeometryThickness, LineAntiAliasingFilterRadius, LineMiterAngleLimit);
+		CapBuilder.LineLength = 1.0f;
+		CapBuilder.PositionAlongLine = Stream.ArcLengths[NewHeadPoint];
+		FVector2f Direction;
+		float Length;
+		(Stream.Points[NewHeadPoint + 1] - Stream.Points[NewHeadPoint]).ToDirectionAndLength(Direction, Length);
+		CapBuilder.MakeStartCap(Stream.Points[NewHeadPoint], Direction, Length, Direction.GetRotated(90.0f) * CapBuilder.LocalHalfThickness, RenderData.VertexColor);
+		check(CapRenderData.VertexData.Num() == 4);
+		for (int32 Index = 0; Index < 4; ++Index)
+		{
+			RenderData.LocalPositionX[CapVertex + Index] = CapRenderData.LocalPositionX[Index];
+			RenderData.LocalPositionY[CapVertex + Index] = CapRenderData.LocalPositionY[Index];
+			RenderData.VertexData[CapVertex + Index] = CapRenderData.VertexData[Index];
+		}
+		Stream.NumDeadVertices = CapVertex;
+		Stream.NumDeadIndices = Stream.FirstIndices[NewHeadPoint] - 6;
+		OutHeadCapVertex = CapVertex;
+	}
+	else
+	{
+		Stream.NumDeadVertices = Stream.FirstVertices[NewHeadPoint];
+		Stream.NumDeadIndices = Stream.FirstIndices[NewHeadPoint];
+	}
 
-	GetLineDrawerWidget().Invalidate(EInvalidateWidgetReason::Paint);
-	return LineDatas.Emplace(MoveTemp(NewLineData));
+	for (int32 Index = OldNumDeadIndices; Index < Stream.NumDeadIndices; ++Index)
+	{
+		RenderData.IndexData[Index] = 0;
+	}
+	Stream.HeadPoint = NewHeadPoint;
 }
 
-bool ILineDrawer::UpdateLine(int32 LineIndex, TFunctionRef<bool(FLineDescriptor& OutLineDescriptor)> Updater)
+void ILineDrawer::CompactStreamingLine(FLineData& InOutLineData, bool bForce)
 {
-	if (!LineDatas.IsValidIndex(LineIndex))
+	// Once the trimmed points outnumber the live ones, moving the live ones down costs no more than the trims since the last compaction.
+	FStreamingLine& Stream = *InOutLineData.Streaming;
+	const int32 NumDeadPoints = Stream.HeadPoint;
+	if (NumDeadPoints == 0 || (!bForce && NumDeadPoints < Stream.Points.Num() - NumDeadPoints))
 	{
-		return false;
+		return;
 	}
 
-	FLineData& LineData = LineDatas[LineIndex];
-	if (Updater(LineData.LineDescriptor))
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::CompactStreamingLine);
+
+	// The arc lengths would otherwise grow for as long as points are appended, losing precision. Rebasing by a whole step keeps the
+	// phase of textures tiling at a power of two up to it.
+	const int32 NewHeadPoint = FMath::Min(NumDeadPoints, Stream.ArcLengths.Num() - 1);
+	const float ArcLengthRebase = NewHeadPoint >= 0 ? FMath::FloorToFloat(Stream.ArcLengths[NewHeadPoint] / StreamingArcLengthRebaseStep) * StreamingArcLengthRebaseStep : 0.0f;
+
+	Stream.Points.RemoveAt(0, NumDeadPoints, EAllowShrinking::No);
+	Stream.ArcLengths.RemoveAt(0, NumDeadPoints, EAllowShrinking::No);
+	Stream.FirstVertices.RemoveAt(0, NumDeadPoints, EAllowShrinking::No);
+	Stream.FirstIndices.RemoveAt(0, NumDeadPoints, EAllowShrinking::No);
+	Stream.MiterJoins.RemoveAt(0, NumDeadPoints, EAllowShrinking::No);
+	Stream.HeadPoint = 0;
+	Stream.NumBuiltPoints = FMath::Max(Stream.NumBuiltPoints - NumDeadPoints, 0);
+
+	FRenderData& RenderData = InOutLineData.RenderData;
+	const int32 NumDeadVertices = Stream.NumDeadVertices;
+	const int32 NumDeadIndices = Stream.NumDeadIndices;
+	if (NumDeadVertices > 0 || NumDeadIndices > 0)
 	{
-		LineData.bNeedReEvalInterpCurve = true;
-		GetLineDrawerWidget().Invalidate(EInvalidateWidgetReason::Paint);
+		RenderData.LocalPositionX.RemoveAt(0, NumDeadVertices, EAllowShrinking::No);
+		RenderData.LocalPositionY.RemoveAt(0, NumDeadVertices, EAllowShrinking::No);
+		RenderData.VertexData.RemoveAt(0, NumDeadVertices, EAllowShrinking::No);
+		RenderData.IndexData.RemoveAt(0, NumDeadIndices, EAllowShrinking::No);
+		for (SlateIndex& Index : RenderData.IndexData)
+		{
+			Index -= NumDeadVertices;
+		}
+		for (int32 Point = 0; Point < Stream.NumBuiltPoints; ++Point)
+		{
+			Stream.FirstVertices[Point] -= NumDeadVertices;
+			Stream.FirstIndices[Point] -= NumDeadIndices;
+		}
+		Stream.TailVertex -= NumDeadVertices;
+		Stream.TailIndex -= NumDeadIndices;
+		Stream.NumDeadVertices = Stream.NumDeadIndices = 0;
 	}
 
-	return true;
+	if (ArcLengthRebase > 0.0f)
+	{
+		for (float& ArcLength : Stream.ArcLengths)
+		{
+			ArcLength -= ArcLengthRebase;
+		}
+		// U of the geometry built from them, in both texture coordinates.
+		for (FSlateVertex& Vertex : RenderData.VertexData)
+		{
+			Vertex.TexCoords[0] -= ArcLengthRebase;
+			Vertex.TexCoords[2] -= ArcLengthRebase;
+		}
+	}
+
+	// The bounds only grow between compactions.
+	InOutLineData.SampleBounds = FBox2f(ForceInit);
+	for (const FVector2f& Point : Stream.Points)
+	{
+		InOutLineData.SampleBounds += Point;
+	}
+	InOutLineData.bNeedUpdateSpatialGrid = true;
 }
 
-void ILineDrawer::RemoveLine(int32 LineIndex)
+float ILineDrawer::GetLinePixelPadding(const FLineDescriptor& LineDescriptor)
+{
+	// Half width of the quads plus the worst case miter extension and the outward part of the caps.
+	return (LineDescriptor.Thickness + LineAntiAliasingFilterRadius) * UE_SQRT_2 + LineAntiAliasingFilterRadius * 2.0f;
+}
+
+bool ILineDrawer::IsRenderDataUpToDate(const FLineData& LineData, const FSlateRenderTransform& RenderTransform, float DrawScale)
+{
+	return LineData.RenderDataTransform == RenderTransform && !LineData.bNeedRebuildLocalGeometry && !NeedRebuildLocalGeometry(LineData, DrawScale) && !NeedReEvalForDrawScale(LineData, DrawScale);
+}
+
+bool ILineDrawer::NeedRebuildLocalGeometry(const FLineData& LineData, float DrawScale)
 {
-	if (LineDatas.IsValidIndex(LineIndex))
+	// Instances are flagged when their shape is rebuilt.
+	if (LineData.Instance)
+	{
+		return false;
+	}
+
+	if (LineData.LocalGeometryDrawScale <= 0.0f || (LineData.DecimatedPoints.Num() > 0 && NeedDecimateForDrawScale(LineData, DrawScale)))
 	{
-		LineDatas.RemoveAt(LineIndex);
-		GetLineDrawerWidget().Invalidate(EInvalidateWidgetReason::Paint);
+		return true;
 	}
+
+	// Thickness and the anti-aliasing filter are baked into the local space geometry divided by the DrawScale it was built with,
+	// so only rebuild once the on screen width drifts further than the tolerance from the one requested.
+	const float PixelHalfWidth = LineData.LineDescriptor.Thickness + LineAntiAliasingFilterRadius;
+	const float PixelHalfWidthError = PixelHalfWidth * FMath::Abs(DrawScale / LineData.LocalGeometryDrawScale - 1.0f);
+	return PixelHalfWidthError > GLineDrawerRetriangulateTolerance;
 }
 
-void ILineDrawer::RemoveAllLines()
+void ILineDrawer::TransformRenderData(FRenderData& InOutRenderData, const FSlateRenderTransform& RenderTransform, ESlateVertexRounding Rounding, int32 FirstVertex, int32 NumVerticesToTransform)
 {
-	LineDatas.Empty();
-	GetLineDrawerWidget().Invalidate(EInvalidateWidgetReason::Paint);
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::TransformRenderData);
+
+	check(InOutRenderData.LocalPositionX.Num() == InOutRenderData.VertexData.Num() && InOutRenderData.LocalPositionY.Num() == InOutRenderData.VertexData.Num());
+	const int32 NumVertices = NumVerticesToTransform == INDEX_NONE ? InOutRenderData.VertexData.Num() - FirstVertex : NumVerticesToTransform;
+	check(FirstVertex >= 0 && FirstVertex + NumVertices <= InOutRenderData.VertexData.Num());
+	TransformVertices(InOutRenderData.LocalPositionX.GetData() + FirstVertex, InOutRenderData.LocalPositionY.GetData() + FirstVertex, InOutRenderData.VertexData.GetData() + FirstVertex, NumVertices, RenderTransform, Rounding);
 }
 
-TArray<int32> ILineDrawer::GetAllLines() const
+void ILineDrawer::TransformVertices(const float* LocalX, const float* LocalY, FSlateVertex* Vertices, int32 NumVertices, const FSlateRenderTransform& RenderTransform, ESlateVertexRounding Rounding)
 {
-	TArray<int32> Indexes;
-	Indexes.Reserve(LineDatas.Num());
-	for (auto It = LineDatas.CreateConstIterator(); It; ++It)
+	float M00, M01, M10, M11;
+	RenderTransform.GetMatrix().GetMatrix(M00, M01, M10, M11);
+	const FVector2f Translation = RenderTransform.GetTranslation();
+	const bool bRound = Rounding == ESlateVertexRounding::Enabled;
+
+	const VectorRegister4Float VecM00 = VectorSetFloat1(M00);
+	const VectorRegister4Float VecM01 = VectorSetFloat1(M01);
+	const VectorRegister4Float VecM10 = VectorSetFloat1(M10);
+	const VectorRegister4Float VecM11 = VectorSetFloat1(M11);
+	const VectorRegister4Float VecTranslationX = VectorSetFloat1(Translation.X);
+	const VectorRegister4Float VecTranslationY = VectorSetFloat1(Translation.Y);
+
+	int32 Index = 0;
+	for (; Index + 4 <= NumVertices; Index += 4)
 	{
-		Indexes.Add(It.GetIndex());
+		const VectorRegister4Float X = VectorLoad(LocalX + Index);
+		const VectorRegister4Float Y = VectorLoad(LocalY + Index);
+		VectorRegister4Float OutX = VectorMultiplyAdd(X, VecM00, VectorMultiplyAdd(Y, VecM10, VecTranslationX));
+		VectorRegister4Float OutY = VectorMultiplyAdd(X, VecM01, VectorMultiplyAdd(Y, VecM11, VecTranslationY));
+		if (bRound)
+		{
+			OutX = VectorFloor(VectorAdd(OutX, GlobalVectorConstants::FloatOneHalf));
+			OutY = VectorFloor(VectorAdd(OutY, GlobalVectorConstants::FloatOneHalf));
+		}
+
+		alignas(16) float ScreenX[4];
+		alignas(16) float ScreenY[4];
+		VectorStoreAligned(OutX, ScreenX);
+		VectorStoreAligned(OutY, ScreenY);
+		for (int32 Lane = 0; Lane < 4; ++Lane)
+		{
+			Vertices[Index + Lane].Position = FVector2f(ScreenX[Lane], ScreenY[Lane]);
+		}
 	}
 
-	return Indexes;
+	for (; Index < NumVertices; ++Index)
+	{
+		FVector2f Position(LocalX[Index] * M00 + LocalY[Index] * M10 + Translation.X, LocalX[Index] * M01 + LocalY[Index] * M11 + Translation.Y);
+		if (bRound)
+		{
+			Position = FVector2f(FMath::RoundToFloat(Position.X), FMath::RoundToFloat(Position.Y));
+		}
+		Vertices[Index].Position = Position;
+	}
 }
 
-const FLineDescriptor* ILineDrawer::GetLine(int32 LineIndex)
+void ILineDrawer::FLineHotStore::Add(int32 LineIndex)
 {
-	if (!LineDatas.IsValidIndex(LineIndex))
+	if (LineIndex >= LineSlots.Num())
 	{
-		return nullptr;
+		LineSlots.SetNum(LineIndex + 1, EAllowShrinking::No);
 	}
 
-	return &LineDatas[LineIndex].LineDescriptor;
+	LineSlots[LineIndex] = SlotLines.Add(LineIndex);
+	CullBounds.Add(FBox2f(ForceInit));
+	PixelPaddings.Add(0.0f);
+	RenderDataCurrent.Add(false);
 }
 
-UMaterialInstanceDynamic* ILineDrawer::GetOrCreateMaterialInstanceOfLine(int32 LineIndex)
+void ILineDrawer::FLineHotStore::Remove(int32 LineIndex)
 {
-	if (!LineDatas.IsValidIndex(LineIndex))
+	const int32 Slot = LineSlots[LineIndex];
+	LineSlots[SlotLines.Last()] = Slot;
+	LineSlots[LineIndex] = INDEX_NONE;
+	SlotLines.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	CullBounds.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	PixelPaddings.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+	RenderDataCurrent.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+}
+
+void ILineDrawer::FLineHotStore::Reset()
+{
+	LineSlots.Reset();
+	SlotLines.Reset();
+	CullBounds.Reset();
+	PixelPaddings.Reset();
+	RenderDataCurrent.Reset();
+	DrawScale = 0.0f;
+}
+
+void ILineDrawer::FLineHotStore::Shrink()
+{
+	// Slots past the highest line index left in the sparse array can't be used anymore.
+	LineSlots.SetNum(SlotLines.Num() > 0 ? FMath::Max(SlotLines) + 1 : 0);
+	LineSlots.Shrink();
+	SlotLines.Shrink();
+	CullBounds.Shrink();
+	PixelPaddings.Shrink();
+	RenderDataCurrent.Shrink();
+}
+
+SIZE_T ILineDrawer::FLineHotStore::GetAllocatedSize() const
+{
+	return LineSlots.GetAllocatedSize() + SlotLines.GetAllocatedSize() + CullBounds.GetAllocatedSize() + PixelPaddings.GetAllocatedSize() + RenderDataCurrent.GetAllocatedSize();
+}
+
+void ILineDrawer::FLineBufferPool::Release(FLineData& InOutLineData)
+{
+	const SIZE_T BufferSize = GetAllocatedSize(InOutLineData);
+	const SIZE_T MaxAllocatedSize = static_cast<SIZE_T>(FMath::Max(GLineDrawerBufferPoolSizeMB, 0.0f) * 1024.0f * 1024.0f);
+	if (BufferSize == 0 || AllocatedSize + BufferSize > MaxAllocatedSize)
 	{
-		return nullptr;
+		return;
 	}
 
-	FLineData& LineData = LineDatas[LineIndex];
-	UObject* ResourceObject = LineData.LineDescriptor.Brush.GetResourceObject();
-	if (!ResourceObject)
+	FRenderData& RenderData = InOutLineData.RenderData;
+	const int32 SizeClass = FMath::Min<int32>(FMath::FloorLog2(InOutLineData.InterpCurveSamplePoints.Max()), NumSizeClasses - 1);
+	FLineBuffers& Buffers = SizeClasses[SizeClass].AddDefaulted_GetRef();
+	Buffers.InterpCurveSamplePoints = MoveTemp(InOutLineData.InterpCurveSamplePoints);
+	Buffers.IntervalSampleOffsets = MoveTemp(InOutLineData.IntervalSampleOffsets);
+	Buffers.LocalPositionX = MoveTemp(RenderData.LocalPositionX);
+	Buffers.LocalPositionY = MoveTemp(RenderData.LocalPositionY);
+	Buffers.VertexData = MoveTemp(RenderData.VertexData);
+	Buffers.IndexData = MoveTemp(RenderData.IndexData);
+	Buffers.InterpCurveSamplePoints.Reset();
+	Buffers.IntervalSampleOffsets.Reset();
+	Buffers.LocalPositionX.Reset();
+	Buffers.LocalPositionY.Reset();
+	Buffers.VertexData.Reset();
+	Buffers.IndexData.Reset();
+	AllocatedSize += BufferSize;
+}
+
+void ILineDrawer::FLineBufferPool::Acquire(FLineData& InOutLineData, int32 ExpectedNumSamples)
+{
+	// A set from a few classes up is still a good fit, beyond that the line would sit on mostly unused memory.
+	const int32 FirstSizeClass = FMath::Min<int32>(FMath::CeilLogTwo(FMath::Max(ExpectedNumSamples, 1)), NumSizeClasses - 1);
+	const int32 LastSizeClass = FMath::Min(FirstSizeClass + 2, NumSizeClasses - 1);
+	for (int32 SizeClass = FirstSizeClass; SizeClass <= LastSizeClass; ++SizeClass)
 	{
-		return nullptr;
+		if (SizeClasses[SizeClass].Num() == 0)
+		{
+			continue;
+		}
+
+		FLineBuffers Buffers = SizeClasses[SizeClass].Pop(EAllowShrinking::No);
+		FRenderData& RenderData = InOutLineData.RenderData;
+		InOutLineData.InterpCurveSamplePoints = MoveTemp(Buffers.InterpCurveSamplePoints);
+		InOutLineData.IntervalSampleOffsets = MoveTemp(Buffers.IntervalSampleOffsets);
+		RenderData.LocalPositionX = MoveTemp(Buffers.LocalPositionX);
+		RenderData.LocalPositionY = MoveTemp(Buffers.LocalPositionY);
+		RenderData.VertexData = MoveTemp(Buffers.VertexData);
+		RenderData.IndexData = MoveTemp(Buffers.IndexData);
+		AllocatedSize -= GetAllocatedSize(InOutLineData);
+		return;
 	}
+}
 
-	UMaterialInterface* Material = Cast<UMaterialInterface>(ResourceObject);
-	if (!Material)
+void ILineDrawer::FLineBufferPool::Empty()
+{
+	for (TArray<FLineBuffers>& SizeClass : SizeClasses)
 	{
-		return nullptr;
+		SizeClass.Empty();
 	}
+	AllocatedSize = 0;
+}
 
-	if (UMaterialInstanceDynamic* ExistingMID = Cast<UMaterialInstanceDynamic>(Material))
+int32 ILineDrawer::FLineBufferPool::Num() const
+{
+	int32 NumBuffers = 0;
+	for (const TArray<FLineBuffers>& SizeClass : SizeClasses)
 	{
-		return ExistingMID;
+		NumBuffers += SizeClass.Num();
 	}
+	return NumBuffers;
+}
 
-	UMaterialInstanceDynamic* NewMID = UMaterialInstanceDynamic::Create(Material, nullptr);
-	LineData.LineDescriptor.Brush.SetResourceObject(NewMID);
-	LineData.RenderData.RenderingResourceHandle = FSlateApplication::Get().GetRenderer()->GetResourceHandle(LineData.LineDescriptor.Brush);
-	return NewMID;
+SIZE_T ILineDrawer::FLineBufferPool::GetAllocatedSize(const FLineData& LineData)
+{
+	return LineData.InterpCurveSamplePoints.GetAllocatedSize() + LineData.IntervalSampleOffsets.GetAllocatedSize() + GetRenderDataAllocatedSize(LineData.RenderData);
 }
 
-void ILineDrawer::AddLineDrawerReferencedObjects(FReferenceCollector& Collector) const
+void ILineDrawer::FLineSpatialGrid::UpdateLine(int32 LineIndex, FLineData& InOutLineData)
 {
-	for (FLineData& LineData : LineDatas)
+	RemoveLine(LineIndex, InOutLineData);
+	if (!InOutLineData.SampleBounds.bIsValid)
 	{
-		LineData.LineDescriptor.Brush.AddReferencedObjects(Collector);
+		return;
 	}
-}
 
-DECLARE_STATS_GROUP(TEXT("LineDrawer"), STATGROUP_LineDrawer, STATCAT_Advanced);
-int32 ILineDrawer::DrawLines(const FGeometry& AllottedGeometry, FSlateWindowElementList& OutDrawElements, int32 LayerId) const
-{
-	DECLARE_SCOPE_CYCLE_COUNTER(TEXT("DrawLines"), STAT_LineDrawer_DrawLines, STATGROUP_LineDrawer);
-	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::DrawLines);
+	if (Cells.Num() == 0 && OversizedLines.Num() == 0)
+	{
+		CellSize = FMath::Max(GLineDrawerCullingGridCellSize, 1.0f);
+	}
 
-	ParallelFor(TEXT("ILineDrawer::ParallelUpdateLineRenderData"), LineDatas.Num(), GLineDrawerUpdateLineNumInParallel, [this, &AllottedGeometry](int32 Index)
+	const FIntRect CellRange = GetCellRange(InOutLineData.SampleBounds);
+	InOutLineData.SpatialGridCells = CellRange;
+	if (static_cast<int64>(CellRange.Width() + 1) * (CellRange.Height() + 1) > MaxCellsPerLine)
 	{
-		UpdateLineRenderData(LineDatas[Index], AllottedGeometry);
-	}, GLineDrawerForceSingleThread ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+		OversizedLines.Add(LineIndex);
+		InOutLineData.SpatialGridState = ESpatialGridState::Oversized;
+		return;
+	}
 
-	for (FLineData& LineData : LineDatas)
+	for (int32 CellY = CellRange.Min.Y; CellY <= CellRange.Max.Y; ++CellY)
 	{
-		TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::DrawLines::DrawElements);
-		FRenderData& RenderData = LineData.RenderData;
-		if (RenderData.VertexData.Num() == 0 || RenderData.IndexData.Num() == 0)
+		for (int32 CellX = CellRange.Min.X; CellX <= CellRange.Max.X; ++CellX)
 		{
-			continue;
+			Cells.FindOrAdd(FIntPoint(CellX, CellY)).Add(LineIndex);
 		}
+	}
+	InOutLineData.SpatialGridState = ESpatialGridState::InCells;
+}
 
-		if(!RenderData.RenderingResourceHandle.IsValid())
+void ILineDrawer::FLineSpatialGrid::RemoveLine(int32 LineIndex, FLineData& InOutLineData)
+{
+	if (InOutLineData.SpatialGridState == ESpatialGridState::Oversized)
+	{
+		OversizedLines.RemoveSingleSwap(LineIndex, EAllowShrinking::No);
+	}
+	else if (InOutLineData.SpatialGridState == ESpatialGridState::InCells)
+	{
+		const FIntRect& CellRange = InOutLineData.SpatialGridCells;
+		for (int32 CellY = CellRange.Min.Y; CellY <= CellRange.Max.Y; ++CellY)
 		{
-			RenderData.RenderingResourceHandle = FSlateApplication::Get().GetRenderer()->GetResourceHandle(LineData.LineDescriptor.Brush);
+			for (int32 CellX = CellRange.Min.X; CellX <= CellRange.Max.X; ++CellX)
+			{
+				const FIntPoint Cell(CellX, CellY);
+				if (TArray<int32>* CellLines = Cells.Find(Cell))
+				{
+					CellLines->RemoveSingleSwap(LineIndex, EAllowShrinking::No);
+					if (CellLines->Num() == 0)
+					{
+						Cells.Remove(Cell);
+					}
+				}
+			}
 		}
-
-		FSlateDrawElement::MakeCustomVerts(OutDrawElements, LayerId, RenderData.RenderingResourceHandle, RenderData.VertexData, RenderData.IndexData, nullptr, 0, 0);
 	}
 
-	return LayerId;
+	InOutLineData.SpatialGridState = ESpatialGridState::None;
 }
 
-void ILineDrawer::UpdateLineRenderData(FLineData& InOutLineData, const FGeometry& AllottedGeometry)
+void ILineDrawer::FLineSpatialGrid::Reset()
 {
-	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::UpdateLineRenderData);
+	Cells.Reset();
+	OversizedLines.Reset();
+}
 
-	auto& LineDescriptor = InOutLineData.LineDescriptor;
-	if (InOutLineData.bNeedReEvalInterpCurve)
+void ILineDrawer::FLineSpatialGrid::Query(const FBox2f& QueryBounds, int32 MaxLineIndex, TBitArray<>& InOutVisitedLines, TArray<int32>& OutLineIndices) const
+{
+	// Only the bits of the lines found are cleared afterwards, so a query costs the lines it finds rather than every line index.
+	if (InOutVisitedLines.Num() < MaxLineIndex)
+	{
+		InOutVisitedLines.Add(false, MaxLineIndex - InOutVisitedLines.Num());
+	}
+	const int32 FirstFoundLine = OutLineIndices.Num();
+	auto AddLine = [&InOutVisitedLines, &OutLineIndices](int32 LineIndex)
 	{
-		TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::UpdateLineRenderData::EvalInterpCurve);
-		InOutLineData.InterpCurveSamplePoints.Reset();
-		auto& KeyPoints = LineDescriptor.InterpCurve.Points;
-		if (KeyPoints.Num() > 0)
+		if (!InOutVisitedLines[LineIndex])
 		{
-			const float DynamicResolutionScale = LineDescriptor.DynamicResolutionFactor * AllottedGeometry.GetLocalSize().Length();
-			constexpr float DynamicResolutionUnitCube = 512.0f * 512.0f * 512.0f;
-			check(DynamicResolutionScale >= 0);
-			check(LineDescriptor.Resolution > 0);
-			TArray<float, TInlineAllocator<64>> EvalTValues;
+			InOutVisitedLines[LineIndex] = true;
+			OutLineIndices.Add(LineIndex);
+		}
+	};
 
-			float EvalT = LineDescriptor.InterpCurveStartT;
-			int32 SmallestKeyPointIndex;
-			for (SmallestKeyPointIndex = 0; SmallestKeyPointIndex < KeyPoints.Num() && KeyPoints[SmallestKeyPointIndex].InVal < EvalT; ++SmallestKeyPointIndex){}
+	for (const int32 LineIndex : OversizedLines)
+	{
+		AddLine(LineIndex);
+	}
 
-			while (EvalT <= LineDescriptor.InterpCurveEndT)
+	const FIntRect CellRange = GetCellRange(QueryBounds);
+	if (static_cast<int64>(CellRange.Width() + 1) * (CellRange.Height() + 1) > Cells.Num())
+	{
+		// Zoomed out far enough that walking the occupied cells is cheaper than probing every cell of the query.
+		for (const TPair<FIntPoint, TArray<int32>>& Cell : Cells)
+		{
+			if (Cell.Key.X >= CellRange.Min.X && Cell.Key.X <= CellRange.Max.X && Cell.Key.Y >= CellRange.Min.Y && Cell.Key.Y <= CellRange.Max.Y)
 			{
-				if (KeyPoints.IsValidIndex(SmallestKeyPointIndex))
-				{
-					auto& KeyPoint = KeyPoints[SmallestKeyPointIndex];
-					const float KeyT = KeyPoint.InVal;
-					if (EvalT == KeyT)
-					{
-						++SmallestKeyPointIndex;
-						if (KeyPoint.InterpMode == CIM_Linear)
-						{
-							EvalTValues.Add(EvalT);
-							if (KeyPoints.IsValidIndex(SmallestKeyPointIndex))
-							{
-								EvalT = KeyPoints[SmallestKeyPointIndex].InVal;
-							}
-							else if (EvalT == LineDescriptor.InterpCurveEndT)
-							{
-								break;
-							}
-
-							continue;
-						}
-					}
-					else if (EvalT > KeyT)
-					{
-						EvalT = KeyPoints[SmallestKeyPointIndex].InVal;
-						++SmallestKeyPointIndex;
-					}
-				}
-
-				EvalTValues.Add(EvalT);
-				if (EvalT == LineDescriptor.InterpCurveEndT)
+				for (const int32 LineIndex : Cell.Value)
 				{
-					break;
+					AddLine(LineIndex);
 				}
-
-				const float SecondDerivativeSq = LineDescriptor.InterpCurve.EvalSecondDerivative(EvalT).SquaredLength();
-				const float DynamicResolution = DynamicResolutionScale * SecondDerivativeSq / DynamicResolutionUnitCube;
-				const float Resolution = FMath::Min(LineDescriptor.Resolution + DynamicResolution, LineDescriptor.MaxResolution);
-				EvalT = FMath::Min(EvalT + 1.0f / Resolution, LineDescriptor.InterpCurveEndT);
 			}
-
-			float LineLength = 0.0f;
-			FVector2f PrevPoint;
-			InOutLineData.InterpCurveSamplePoints.SetNumUninitialized(EvalTValues.Num());
-			for (int32 Index = 0; Index < EvalTValues.Num(); ++Index)
+		}
+	}
+	else
+	{
+		for (int32 CellY = CellRange.Min.Y; CellY <= CellRange.Max.Y; ++CellY)
+		{
+			for (int32 CellX = CellRange.Min.X; CellX <= CellRange.Max.X; ++CellX)
 			{
-				const FVector2f CurvePoint = LineDescriptor.InterpCurve.Eval(EvalTValues[Index]);
-				InOutLineData.InterpCurveSamplePoints[Index] = CurvePoint;
-				if (Index > 0)
+				if (const TArray<int32>* CellLines = Cells.Find(FIntPoint(CellX, CellY)))
 				{
-					LineLength += (CurvePoint - PrevPoint).Size();
+					for (const int32 LineIndex : *CellLines)
+					{
+						AddLine(LineIndex);
+					}
 				}
-				PrevPoint = CurvePoint;
 			}
-			InOutLineData.LineLength = LineLength;
 		}
+	}
 
-		InOutLineData.bNeedReEvalInterpCurve = false;
+	for (int32 Index = FirstFoundLine; Index < OutLineIndices.Num(); ++Index)
+	{
+		InOutVisitedLines[OutLineIndices[Index]] = false;
 	}
+}
 
+FIntRect ILineDrawer::FLineSpatialGrid::GetCellRange(const FBox2f& Bounds) const
+{
+	constexpr float MaxCellCoord = 1 << 20;
+	auto ToCell = [this, MaxCellCoord](float Coord)
 	{
-		auto& RenderData = InOutLineData.RenderData;
-		RenderData.VertexData.Reset();
-		RenderData.IndexData.Reset();
-		const int32 NumSamples = InOutLineData.InterpCurveSamplePoints.Num();
-		if (NumSamples < 2 || InOutLineData.LineLength <= KINDA_SMALL_NUMBER)
-		{
-			return;
-		}
+		return FMath::FloorToInt32(FMath::Clamp(Coord / CellSize, -MaxCellCoord, MaxCellCoord));
+	};
 
-		FPaintGeometry PaintGeometry = AllottedGeometry.ToPaintGeometry();
-		constexpr float AntiAliasingFilterRadius = 2.0f;
-		constexpr float MiterAngleLimit = 90.0f - KINDA_SMALL_NUMBER;
-		FLineBuilder LineBuilder(RenderData, PaintGeometry.GetAccumulatedRenderTransform(), PaintGeometry.DrawScale, LineDescriptor.Thickness, AntiAliasingFilterRadius, MiterAngleLimit);
-		FColor TintColor = LineDescriptor.Brush.TintColor.GetSpecifiedColor().ToFColor(true);
-		LineBuilder.BuildLineGeometry(InOutLineData.InterpCurveSamplePoints, InOutLineData.LineLength, TintColor, ESlateVertexRounding::Enabled);
-	}
+	return FIntRect(ToCell(Bounds.Min.X), ToCell(Bounds.Min.Y), ToCell(Bounds.Max.X), ToCell(Bounds.Max.Y));
 }
 
-ILineDrawer::FLineBuilder::FLineBuilder(FRenderData& RenderData, const FSlateRenderTransform& RenderTransform, float ElementScale, float HalfThickness, float FilterRadius, float MiterAngleLimit) :
+ILineDrawer::FLineBuilder::FLineBuilder(FRenderData& RenderData, float ElementScale, float HalfThickness, float FilterRadius, float MiterAngleLimit) :
 	RenderData(RenderData),
-	RenderTransform(RenderTransform),
 	LocalHalfThickness((HalfThickness + FilterRadius) / ElementScale),
 	LocalFilterRadius(FilterRadius / ElementScale),
 	LocalCapLength((FilterRadius / ElementScale) * 2.0f),
@@ -310,7 +4380,7 @@ ILineDrawer::FLineBuilder::FLineBuilder(FRenderData& RenderData, const FSlateRen
 {
 }
 
-void ILineDrawer::FLineBuilder::BuildLineGeometry(const TArray<FVector2f>& Points, float InLineLength, const FColor& PointColor, ESlateVertexRounding Rounding)
+void ILineDrawer::FLineBuilder::BuildLineGeometry(TConstArrayView<FVector2f> Points, float InLineLength, const FColor& PointColor)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::FLineBuilder::BuildLineGeometry);
 
@@ -328,7 +4398,7 @@ void ILineDrawer::FLineBuilder::BuildLineGeometry(const TArray<FVector2f>& Point
 	FVector2f Up = SegDirection.GetRotated(90.0f) * LocalHalfThickness;
 	PositionAlongLine = 0.0f;
 
-	MakeStartCap(Position, SegDirection, SegLength, Up, PointColor, Rounding);
+	MakeStartCap(Position, SegDirection, SegLength, Up, PointColor);
 
 	PositionAlongLine += SegLength;
 
@@ -345,39 +4415,105 @@ void ILineDrawer::FLineBuilder::BuildLineGeometry(const TArray<FVector2f>& Point
 		(NextPosition - Position).ToDirectionAndLength(SegDirection, SegLength);
 		Up = SegDirection.GetRotated(90.0f) * LocalHalfThickness;
 
-		const FVector2f MiterNormal = GetMiterNormal(LastDirection, SegDirection);
-		const float DistanceToMiterLine = FVector2f::DotProduct(Up, MiterNormal);
+		AddJoin(Position, LastDirection, LastLength, LastUp, SegDirection, SegLength, Up, PointColor);
 
-		const float DirDotMiterNormal = FVector2f::DotProduct(SegDirection, MiterNormal);
-		const float MinSegmentLength = FMath::Min(LastLength, SegLength);
+		PositionAlongLine += SegLength;
+	}
 
-		if (MinSegmentLength > SMALL_NUMBER && DirDotMiterNormal >= AngleCosineLimit && (MinSegmentLength * 0.5f * DirDotMiterNormal) >= FMath::Abs(DistanceToMiterLine))
-		{
-			const float ParallelDistance = DistanceToMiterLine / DirDotMiterNormal;
-			const FVector2f MiterUp = Up - (SegDirection * ParallelDistance);
+	MakeEndCap(NextPosition, SegDirection, SegLength, Up, PointColor);
+}
 
-			const float MiterOffset = FVector2f::DotProduct(SegDirection, MiterUp);
-			RenderData.VertexData.Emplace(FSlateVertex::Make(RenderTransform, FVector2f(Position + MiterUp),
-			                                                 FVector2f((PositionAlongLine - MiterOffset) / LineLength, 1.0f),
-			                                                 FVector2f(PositionAlongLine - MiterOffset, 1.0f), PointColor, {}, Rounding));
-			RenderData.VertexData.Emplace(FSlateVertex::Make(RenderTransform, FVector2f(Position - MiterUp),
-			                                                 FVector2f((PositionAlongLine + MiterOffset) / LineLength, 0.0f),
-			                                                 FVector2f(PositionAlongLine + MiterOffset, 0.0f), PointColor, {}, Rounding));
-			AddQuadIndices(RenderData);
-		}
-		else
-		{
-			MakeEndCap(Position, LastDirection, LastLength, LastUp, PointColor, Rounding);
-			MakeStartCap(Position, SegDirection, SegLength, Up, PointColor, Rounding);
-		}
+void ILineDrawer::FLineBuilder::BuildStreamingGeometry(FStreamingLine& Stream, const FColor& PointColor)
+{
+	const TArray<FVector2f>& Points = Stream.Points;
+	const int32 NumPoints = Points.Num();
+	if (NumPoints - Stream.HeadPoint < 2 || NumPoints == Stream.NumBuiltPoints)
+	{
+		return;
+	}
 
-		PositionAlongLine += SegLength;
+	TRACE_CPUPROFILER_EVENT_SCOPE(ILineDrawer::FLineBuilder::BuildStreamingGeometry);
+
+	// U is the running arc length, so the geometry already built stays valid as the line grows.
+	LineLength = 1.0f;
+	FVector2f SegDirection;
+	float SegLength;
+	int32 Point;
+	if (Stream.NumBuiltPoints - Stream.HeadPoint < 2)
+	{
+		Point = Stream.HeadPoint;
+		Stream.FirstVertices[Point] = RenderData.VertexData.Num();
+		Stream.FirstIndices[Point] = RenderData.IndexData.Num();
+		Stream.MiterJoins[Point] = false;
+		(Points[Point + 1] - Points[Point]).ToDirectionAndLength(SegDirection, SegLength);
+		PositionAlongLine = Stream.ArcLengths[Point];
+		MakeStartCap(Points[Point], SegDirection, SegLength, SegDirection.GetRotated(90.0f) * LocalHalfThickness, PointColor);
+		++Point;
+	}
+	else
+	{
+		// The old last point becomes a join, so its end cap goes.
+		RenderData.LocalPositionX.SetNum(Stream.TailVertex, EAllowShrinking::No);
+		RenderData.LocalPositionY.SetNum(Stream.TailVertex, EAllowShrinking::No);
+		RenderData.VertexData.SetNum(Stream.TailVertex, EAllowShrinking::No);
+		RenderData.IndexData.SetNum(Stream.TailIndex, EAllowShrinking::No);
+		Point = Stream.NumBuiltPoints - 1;
+		(Points[Point] - Points[Point - 1]).ToDirectionAndLength(SegDirection, SegLength);
+	}
+	FVector2f Up = SegDirection.GetRotated(90.0f) * LocalHalfThickness;
+
+	for (; Point < NumPoints - 1; ++Point)
+	{
+		const FVector2f LastDirection = SegDirection;
+		const FVector2f LastUp = Up;
+		const float LastLength = SegLength;
+
+		(Points[Point + 1] - Points[Point]).ToDirectionAndLength(SegDirection, SegLength);
+		Up = SegDirection.GetRotated(90.0f) * LocalHalfThickness;
+
+		PositionAlongLine = Stream.ArcLengths[Point];
+		const bool bMiter = AddJoin(Points[Point], LastDirection, LastLength, LastUp, SegDirection, SegLength, Up, PointColor);
+
+		// The segment starts at the two miter vertices, or at its start cap when the segment is long enough to have one.
+		const bool bStartCap = !bMiter && SegLength > SMALL_NUMBER;
+		Stream.FirstVertices[Point] = RenderData.VertexData.Num() - (bMiter ? 2 : (bStartCap ? 4 : 0));
+		Stream.FirstIndices[Point] = RenderData.IndexData.Num() - (bStartCap ? 6 : 0);
+		Stream.MiterJoins[Point] = bMiter;
+	}
+
+	Stream.TailVertex = RenderData.VertexData.Num();
+	Stream.TailIndex = RenderData.IndexData.Num();
+	PositionAlongLine = Stream.ArcLengths[NumPoints - 1];
+	MakeEndCap(Points[NumPoints - 1], SegDirection, SegLength, Up, PointColor);
+	Stream.NumBuiltPoints = NumPoints;
+}
+
+bool ILineDrawer::FLineBuilder::AddJoin(const FVector2f Position, const FVector2f LastDirection, float LastLength, const FVector2f LastUp, const FVector2f Direction, float SegmentLength, const FVector2f Up, const FColor& Color)
+{
+	const FVector2f MiterNormal = GetMiterNormal(LastDirection, Direction);
+	const float DistanceToMiterLine = FVector2f::DotProduct(Up, MiterNormal);
+
+	const float DirDotMiterNormal = FVector2f::DotProduct(Direction, MiterNormal);
+	const float MinSegmentLength = FMath::Min(LastLength, SegmentLength);
+
+	if (MinSegmentLength > SMALL_NUMBER && DirDotMiterNormal >= AngleCosineLimit && (MinSegmentLength * 0.5f * DirDotMiterNormal) >= FMath::Abs(DistanceToMiterLine))
+	{
+		const float ParallelDistance = DistanceToMiterLine / DirDotMiterNormal;
+		const FVector2f MiterUp = Up - (Direction * ParallelDistance);
+
+		const float MiterOffset = FVector2f::DotProduct(Direction, MiterUp);
+		AddVertex(FVector2f(Position + MiterUp), FVector2f((PositionAlongLine - MiterOffset) / LineLength, 1.0f), FVector2f(PositionAlongLine - MiterOffset, 1.0f), Color);
+		AddVertex(FVector2f(Position - MiterUp), FVector2f((PositionAlongLine + MiterOffset) / LineLength, 0.0f), FVector2f(PositionAlongLine + MiterOffset, 0.0f), Color);
+		AddQuadIndices(RenderData);
+		return true;
 	}
 
-	MakeEndCap(NextPosition, SegDirection, SegLength, Up, PointColor, Rounding);
+	MakeEndCap(Position, LastDirection, LastLength, LastUp, Color);
+	MakeStartCap(Position, Direction, SegmentLength, Up, Color);
+	return false;
 }
 
-void ILineDrawer::FLineBuilder::MakeStartCap(const FVector2f Position, const FVector2f Direction, float SegmentLength, const FVector2f Up, const FColor& Color, ESlateVertexRounding Rounding)
+void ILineDrawer::FLineBuilder::MakeStartCap(const FVector2f Position, const FVector2f Direction, float SegmentLength, const FVector2f Up, const FColor& Color)
 {
 	if (SegmentLength > SMALL_NUMBER)
 	{
@@ -388,23 +4524,15 @@ void ILineDrawer::FLineBuilder::MakeStartCap(const FVector2f Position, const FVe
 		const FVector2f CapInward = Direction * InwardDistance;
 		const FVector2f CapOutward = Direction * OutwardDistance;
 
-		RenderData.VertexData.Emplace(FSlateVertex::Make(RenderTransform, FVector2f(Position + CapOutward + Up),
-		                                                 FVector2f((PositionAlongLine + OutwardDistance) / LineLength, 1.0f),
-		                                                 FVector2f(PositionAlongLine + OutwardDistance, 1.0f), Color, {}, Rounding));
-		RenderData.VertexData.Emplace(FSlateVertex::Make(RenderTransform, FVector2f(Position + CapOutward - Up),
-		                                                 FVector2f((PositionAlongLine + OutwardDistance) / LineLength, 0.0f),
-		                                                 FVector2f(PositionAlongLine + OutwardDistance, 0.0f), Color, {}, Rounding));
-		RenderData.VertexData.Emplace(FSlateVertex::Make(RenderTransform, FVector2f(Position + CapInward + Up),
-		                                                 FVector2f((PositionAlongLine + InwardDistance) / LineLength, 1.0f),
-		                                                 FVector2f(PositionAlongLine + InwardDistance, 1.0f), Color, {}, Rounding));
-		RenderData.VertexData.Emplace(FSlateVertex::Make(RenderTransform, FVector2f(Position + CapInward - Up),
-		                                                 FVector2f((PositionAlongLine + InwardDistance) / LineLength, 0.0f),
-		                                                 FVector2f(PositionAlongLine + InwardDistance, 0.0f), Color, {}, Rounding));
+		AddVertex(FVector2f(Position + CapOutward + Up), FVector2f((PositionAlongLine + OutwardDistance) / LineLength, 1.0f), FVector2f(PositionAlongLine + OutwardDistance, 1.0f), Color);
+		AddVertex(FVector2f(Position + CapOutward - Up), FVector2f((PositionAlongLine + OutwardDistance) / LineLength, 0.0f), FVector2f(PositionAlongLine + OutwardDistance, 0.0f), Color);
+		AddVertex(FVector2f(Position + CapInward + Up), FVector2f((PositionAlongLine + InwardDistance) / LineLength, 1.0f), FVector2f(PositionAlongLine + InwardDistance, 1.0f), Color);
+		AddVertex(FVector2f(Position + CapInward - Up), FVector2f((PositionAlongLine + InwardDistance) / LineLength, 0.0f), FVector2f(PositionAlongLine + InwardDistance, 0.0f), Color);
 		AddQuadIndices(RenderData);
 	}
 }
 
-void ILineDrawer::FLineBuilder::MakeEndCap(const FVector2f Position, const FVector2f Direction, float SegmentLength, const FVector2f Up, const FColor& Color, ESlateVertexRounding Rounding)
+void ILineDrawer::FLineBuilder::MakeEndCap(const FVector2f Position, const FVector2f Direction, float SegmentLength, const FVector2f Up, const FColor& Color)
 {
 	if (SegmentLength > SMALL_NUMBER)
 	{
@@ -415,24 +4543,23 @@ void ILineDrawer::FLineBuilder::MakeEndCap(const FVector2f Position, const FVect
 		const FVector2f CapInward = Direction * -InwardDistance;
 		const FVector2f CapOutward = Direction * OutwardDistance;
 
-		RenderData.VertexData.Emplace(FSlateVertex::Make(RenderTransform, FVector2f(Position + CapInward + Up),
-		                                                 FVector2f((PositionAlongLine - InwardDistance) / LineLength, 1.0f),
-		                                                 FVector2f(PositionAlongLine - InwardDistance, 1.0f), Color, {}, Rounding));
-		RenderData.VertexData.Emplace(FSlateVertex::Make(RenderTransform, FVector2f(Position + CapInward - Up),
-		                                                 FVector2f((PositionAlongLine - InwardDistance) / LineLength, 0.0f),
-		                                                 FVector2f(PositionAlongLine - InwardDistance, 0.0f), Color, {}, Rounding));
+		AddVertex(FVector2f(Position + CapInward + Up), FVector2f((PositionAlongLine - InwardDistance) / LineLength, 1.0f), FVector2f(PositionAlongLine - InwardDistance, 1.0f), Color);
+		AddVertex(FVector2f(Position + CapInward - Up), FVector2f((PositionAlongLine - InwardDistance) / LineLength, 0.0f), FVector2f(PositionAlongLine - InwardDistance, 0.0f), Color);
 		AddQuadIndices(RenderData);
 
-		RenderData.VertexData.Emplace(FSlateVertex::Make(RenderTransform, FVector2f(Position + CapOutward + Up),
-		                                                 FVector2f((PositionAlongLine + OutwardDistance) / LineLength, 1.0f),
-		                                                 FVector2f(PositionAlongLine + OutwardDistance, 1.0f), Color, {}, Rounding));
-		RenderData.VertexData.Emplace(FSlateVertex::Make(RenderTransform, FVector2f(Position + CapOutward - Up),
-		                                                 FVector2f((PositionAlongLine + OutwardDistance) / LineLength, 0.0f),
-		                                                 FVector2f(PositionAlongLine + OutwardDistance, 0.0f), Color, {}, Rounding));
+		AddVertex(FVector2f(Position + CapOutward + Up), FVector2f((PositionAlongLine + OutwardDistance) / LineLength, 1.0f), FVector2f(PositionAlongLine + OutwardDistance, 1.0f), Color);
+		AddVertex(FVector2f(Position + CapOutward - Up), FVector2f((PositionAlongLine + OutwardDistance) / LineLength, 0.0f), FVector2f(PositionAlongLine + OutwardDistance, 0.0f), Color);
 		AddQuadIndices(RenderData);
 	}
 }
 
+void ILineDrawer::FLineBuilder::AddVertex(const FVector2f LocalPosition, const FVector2f TexCoord, const FVector2f TexCoord2, const FColor& Color)
+{
+	RenderData.LocalPositionX.Add(LocalPosition.X);
+	RenderData.LocalPositionY.Add(LocalPosition.Y);
+	RenderData.VertexData.Emplace(FSlateVertex::Make(FSlateRenderTransform(), LocalPosition, TexCoord, TexCoord2, Color, {}, ESlateVertexRounding::Disabled));
+}
+
 void ILineDrawer::FLineBuilder::AddQuadIndices(FRenderData& InRenderData)
 {
 	const int32 NumVerts = InRenderData.VertexData.Num();
@@ -23,7 +23,7 @@ FString SLineDrawerWidget::GetReferencerName() const
 
 int32 SLineDrawerWidget::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
 {
-	return DrawLines(AllottedGeometry, OutDrawElements, LayerId);
+	return DrawLines(AllottedGeometry, MyCullingRect, OutDrawElements, LayerId);
 }
 
 FVector2D SLineDrawerWidget::ComputeDesiredSize(float) const
@@ -34,10 +34,35 @@ FVector2D SLineDrawerWidget::ComputeDesiredSize(float) const
 void FLineWithAutoTangent::WritePointsToLineDescriptor(const FSplineTangentSettings& TangentSettings)
 {
 	LineDescriptor.SetCurvePointsWithAutoTangents(Points, InterpStartT, InterpEndT, InterpMode, TangentSettings);
+	PointsHash = GetPointsHash(TangentSettings);
+}
+
+uint32 FLineWithAutoTangent::GetPointsHash(const FSplineTangentSettings& TangentSettings) const
+{
+	uint32 Hash = GetTypeHash(Points.Num());
+	for (const FVector2f& Point : Points)
+	{
+		Hash = HashCombineFast(Hash, GetTypeHash(Point));
+	}
+	Hash = HashCombineFast(Hash, GetTypeHash(InterpStartT));
+	Hash = HashCombineFast(Hash, GetTypeHash(InterpEndT));
+	Hash = HashCombineFast(Hash, GetTypeHash(InterpMode.GetValue()));
+	Hash = HashCombineFast(Hash, GetTypeHash(TangentSettings.bTranspose));
+	Hash = HashCombineFast(Hash, GetTypeHash(TangentSettings.SplineHorizontalDeltaRange));
+	Hash = HashCombineFast(Hash, GetTypeHash(TangentSettings.SplineVerticalDeltaRange));
+	Hash = HashCombineFast(Hash, GetTypeHash(TangentSettings.SplineTangentFromHorizontalDelta));
+	Hash = HashCombineFast(Hash, GetTypeHash(TangentSettings.SplineTangentFromVerticalDelta));
+	return Hash;
 }
 
 TSharedRef<SWidget> ULineDrawerWidget::RebuildWidget()
 {
+	// The indices belong to the previous drawer, if any.
+	for (FLineWithAutoTangent& Line : Lines)
+	{
+		Line.LineIndex = INDEX_NONE;
+	}
+
 	MyLineDrawerWidget = SNew(SLineDrawerWidget);
 	return MyLineDrawerWidget.ToSharedRef();
 }
@@ -46,32 +71,59 @@ void ULineDrawerWidget::SynchronizeProperties()
 {
 	Super::SynchronizeProperties();
 
-	if (MyLineDrawerWidget.IsValid())
+	if (!MyLineDrawerWidget.IsValid())
 	{
-		for (FLineWithAutoTangent& Line : Lines)
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(ULineDrawerWidget::SynchronizeProperties);
+
+	// Runs on every property change in the designer, so only the lines that actually changed are pushed to the drawer.
+	TSet<int32> SyncedLines;
+	SyncedLines.Reserve(Lines.Num());
+	for (FLineWithAutoTangent& Line : Lines)
+	{
+		const FLineDescriptor* DrawnLineDescriptor = Line.LineIndex != INDEX_NONE ? MyLineDrawerWidget->GetLine(Line.LineIndex) : nullptr;
+
+		// A line duplicated in the details panel comes with the index of the original.
+		bool bLineAlreadySynced = false;
+		if (DrawnLineDescriptor)
+		{
+			SyncedLines.Add(Line.LineIndex, &bLineAlreadySynced);
+		}
+
+		if (!DrawnLineDescriptor || bLineAlreadySynced)
 		{
 			Line.WritePointsToLineDescriptor(AutoTangentSettings);
+			Line.LineIndex = MyLineDrawerWidget->AddLine(Line.LineDescriptor);
+			SyncedLines.Add(Line.LineIndex);
+			continue;
+		}
 
-			if (Line.LineIndex == INDEX_NONE)
-			{
-				Line.LineIndex = MyLineDrawerWidget->AddLine(Line.LineDescriptor);
-			}
-			else
-			{
-				if (MyLineDrawerWidget->GetLine(Line.LineIndex))
-				{
-					MyLineDrawerWidget->UpdateLine(Line.LineIndex, [&Line](FLineDescriptor& OutLineDescriptor)
-					{
-						OutLineDescriptor = Line.LineDescriptor;
-						return true;
-					});
-				}
-				else
-				{
-					Line.LineIndex = MyLineDrawerWidget->AddLine(Line.LineDescriptor);
-				}
-			}
+		const bool bPointsChanged = Line.GetPointsHash(AutoTangentSettings) != Line.PointsHash;
+		if (!bPointsChanged && FLineDescriptor::StaticStruct()->CompareScriptStruct(&Line.LineDescriptor, DrawnLineDescriptor, PPF_None))
+		{
+			continue;
 		}
+
+		if (bPointsChanged)
+		{
+			Line.WritePointsToLineDescriptor(AutoTangentSettings);
+		}
+
+		// The drawer compares the curve with the one it sampled, a descriptor only change doesn't re-sample it.
+		MyLineDrawerWidget->UpdateLine(Line.LineIndex, [&Line](FLineDescriptor& OutLineDescriptor)
+		{
+			OutLineDescriptor = Line.LineDescriptor;
+			return true;
+		});
+	}
+
+	TArray<int32> RemovedLines = MyLineDrawerWidget->GetAllLines();
+	RemovedLines.RemoveAllSwap([&SyncedLines](int32 LineIndex) { return SyncedLines.Contains(LineIndex); });
+	if (RemovedLines.Num() > 0)
+	{
+		MyLineDrawerWidget->RemoveLines(RemovedLines);
 	}
 }
 
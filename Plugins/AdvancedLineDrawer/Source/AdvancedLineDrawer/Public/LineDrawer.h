@@ -3,6 +3,8 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Containers/MpscQueue.h"
+#include "Tasks/Task.h"
 #include "LineDrawer.generated.h"
 
 USTRUCT()
@@ -26,15 +28,47 @@ struct ADVANCEDLINEDRAWER_API FSplineTangentSettings
 	FVector2f SplineTangentFromVerticalDelta = {1.0f, 0.0f};
 };
 
+UENUM()
+enum class ELineTessellationMode : uint8
+{
+	// Steps through the curve at Resolution samples per unit of T, adding samples where the curve bends.
+	Resolution,
+	// Subdivides every key interval until the samples are within TessellationTolerance pixels of the curve.
+	ScreenSpaceTolerance
+};
+
+UENUM()
+enum class ELineDecimationMode : uint8
+{
+	None,
+	// Keeps the first, last, lowest and highest point of every run of points in the same pixel column. For time series along X.
+	MinMaxPerPixel,
+	// Douglas-Peucker simplification to within DecimationTolerance pixels. For general paths.
+	Tolerance
+};
+
 USTRUCT()
 struct ADVANCEDLINEDRAWER_API FLineDescriptor
 {
 	GENERATED_BODY();
 
+	// Keys are written in blocks, vectorized for curve modes and split across workers for large point sets.
 	void SetCurvePointsWithAutoTangents(const TArray<FVector2f>& Points, float InterpStartT = 0.0f, float InterpEndT = 1.0f, EInterpCurveMode InterpMode = CIM_CurveUser, const FSplineTangentSettings& TangentSettings = FSplineTangentSettings());
 
 	int32 AddPoint(const FVector2f& Point, float InterpT, EInterpCurveMode InterpMode = CIM_CurveAuto, const FVector2f& ArriveTangent = FVector2f::Zero(), const FVector2f& LeaveTangent = FVector2f::Zero());
 
+	// Moves an existing point while keeping its InterpT.
+	void SetPoint(int32 PointIndex, const FVector2f& Point);
+	void SetPoint(int32 PointIndex, const FVector2f& Point, const FVector2f& ArriveTangent, const FVector2f& LeaveTangent);
+
+	// Draws the points as they are instead of sampling InterpCurve, which is then ignored. The buffer is shared with the line rather
+	// than copied, so it must not be modified once set: pass a new buffer to change the points, or null to go back to the curve.
+	void SetPolylinePoints(TSharedPtr<const TArray<FVector2f>> Points);
+	void SetPolylinePoints(TArray<FVector2f>&& Points);
+	bool IsPolyline() const { return PolylinePoints.IsValid(); }
+	const TSharedPtr<const TArray<FVector2f>>& GetPolylinePoints() const { return PolylinePoints; }
+
+	// Updates that keep the number of keys and their InVal only re-sample the key intervals next to the keys that changed.
 	FInterpCurve<FVector2f> InterpCurve;
 
 	UPROPERTY(EditAnywhere)
@@ -49,6 +83,20 @@ struct ADVANCEDLINEDRAWER_API FLineDescriptor
 	UPROPERTY(EditAnywhere)
 	float MaxResolution = 64;
 
+	UPROPERTY(EditAnywhere)
+	ELineTessellationMode TessellationMode = ELineTessellationMode::Resolution;
+
+	UPROPERTY(EditAnywhere)
+	float TessellationTolerance = 0.25f;
+
+	// Thins out the samples or polyline points before building the geometry, for lines with far more points than pixels.
+	// Redone when the zoom changes enough for the dropped points to show.
+	UPROPERTY(EditAnywhere)
+	ELineDecimationMode Decimation = ELineDecimationMode::None;
+
+	UPROPERTY(EditAnywhere)
+	float DecimationTolerance = 0.25f;
+
 	UPROPERTY(EditAnywhere)
 	float InterpCurveStartT = 0.0f;
 
@@ -57,62 +105,559 @@ struct ADVANCEDLINEDRAWER_API FLineDescriptor
 
 	UPROPERTY(EditAnywhere)
 	FSlateBrush Brush;
+
+private:
+	friend class ILineDrawer;
+
+	TSharedPtr<const TArray<FVector2f>> PolylinePoints;
 };
 
 class ADVANCEDLINEDRAWER_API ILineDrawer
 {
 public:
-	virtual ~ILineDrawer() = default;
+	ILineDrawer();
+	virtual ~ILineDrawer();
 
 	int32 AddLine(const FLineDescriptor& LineDescriptor);
+	int32 AddLine(FLineDescriptor&& LineDescriptor);
 	bool UpdateLine(int32 LineIndex, TFunctionRef<bool(FLineDescriptor& OutLineDescriptor)> Updater);
 	void RemoveLine(int32 LineIndex);
 	void RemoveAllLines();
 
+	// Batch versions of the above that invalidate the widget once for the whole batch.
+	TArray<int32> AddLines(TConstArrayView<FLineDescriptor> LineDescriptors);
+	TArray<int32> AddLines(TArray<FLineDescriptor>&& LineDescriptors);
+	int32 UpdateLines(TConstArrayView<int32> LineIndices, TFunctionRef<bool(int32 LineIndex, FLineDescriptor& OutLineDescriptor)> Updater);
+	void RemoveLines(TConstArrayView<int32> LineIndices);
+
+	// Style only updates. They reuse the sampled curve, a color change only patches the vertex colors in place.
+	// UpdateLine detects the same kinds of changes, these just avoid writing an updater for them.
+	bool SetLineColor(int32 LineIndex, const FLinearColor& Color);
+	void SetLinesColor(TConstArrayView<int32> LineIndices, const FLinearColor& Color);
+	bool SetLineThickness(int32 LineIndex, float Thickness);
+
+	// Streaming lines keep the last Capacity points appended to them, for live plots. Painting only tessellates what was appended
+	// since the last paint and drops the head of the line without touching the rest. The curve and polyline points of the
+	// descriptor are ignored. U is the running arc length rather than 0 to 1 along the line, so textures scroll with the points.
+	// It is rebased by whole multiples of StreamingArcLengthRebaseStep as the head is dropped, which textures tiling at a power of
+	// two up to that step don't show.
+	int32 AddStreamingLine(FLineDescriptor&& LineDescriptor, int32 Capacity);
+	bool AppendPoints(int32 LineIndex, TConstArrayView<FVector2f> Points);
+
+	// Shapes are sampled and triangulated once however many instances of them are drawn. An instance is a line that only moves the
+	// geometry of its shape into the widget with its Transform and multiplies its color by Tint, so its width scales with the
+	// transform. Instances are culled, batched, hit tested and removed like any other line, their descriptor only carries the brush.
+	// Removing a shape removes its instances.
+	int32 AddLineShape(FLineDescriptor&& LineDescriptor);
+	bool UpdateLineShape(int32 ShapeIndex, TFunctionRef<bool(FLineDescriptor& OutLineDescriptor)> Updater);
+	void RemoveLineShape(int32 ShapeIndex);
+	int32 AddLineInstance(int32 ShapeIndex, const FSlateRenderTransform& Transform, const FLinearColor& Tint = FLinearColor::White);
+	bool SetLineInstanceTransform(int32 LineIndex, const FSlateRenderTransform& Transform);
+	bool SetLineInstanceTint(int32 LineIndex, const FLinearColor& Tint);
+
+	// Draws the lines of Source instead of lines of its own, for several views of the same lines such as a graph and its minimap.
+	// The lines are stored, edited and sampled once in Source, at the geometry and scale Source is painted with. This drawer only
+	// builds and caches their geometry at its own geometry and scale, and keeps drawing what it has until Source is painted with
+	// an edit. Painting a view never changes Source. Lines are only added to and edited through Source, with the same line indices
+	// in every view of it: the edit and add calls of a view fail. Shape instances of Source are not drawn by its views. Pass null
+	// to unsubscribe.
+	void SetLineSource(ILineDrawer* Source);
+
+	// Line edits from any thread, for producers running in tasks. Commands are queued without a lock and applied together on the
+	// game thread by the next paint or FlushLineCommands, with the commands of each line folded into one in the order they were
+	// enqueued: the last add or remove of a handle decides whether its line exists, so a line removed and added again is added
+	// back, with the descriptor of the last add or update after it. Updates of a handle without a line are dropped. Producers
+	// name lines by handles reserved up front on the game thread, as the line index is only known once the add is applied, see
+	// GetLineOfHandle. A handle is kept through removes until released, which removes its line and lets ReserveLineHandles hand
+	// it out again. The descriptors are moved through the queue and replace the whole descriptor of the line. Not for drawers
+	// subscribed to a source.
+	TArray<int32> ReserveLineHandles(int32 NumHandles = 1);
+	void EnqueueAddLine(int32 LineHandle, FLineDescriptor&& LineDescriptor);
+	void EnqueueUpdateLine(int32 LineHandle, FLineDescriptor&& LineDescriptor);
+	void EnqueueRemoveLine(int32 LineHandle);
+	void EnqueueReleaseLineHandle(int32 LineHandle);
+	void FlushLineCommands();
+	// INDEX_NONE until the add of the handle is applied, and once the line is removed, by a command or directly.
+	int32 GetLineOfHandle(int32 LineHandle) const;
+
+	// Hit testing in the local space of the widget, against the samples of the lines as last painted. Distances are to the center
+	// of the line, add half its thickness to test against its edges. Lines in flight in async tessellation are skipped until
+	// their job lands.
+	struct FLineHit
+	{
+		int32 LineIndex = INDEX_NONE;
+		// Curve input value of the hit, placed in its key interval by sample count. For polylines and streaming lines, the index
+		// of the point the hit segment starts at plus the fraction along it.
+		float T = 0.0f;
+		float Distance = 0.0f;
+		FVector2f Position = FVector2f::ZeroVector;
+	};
+	// Nearest line within Tolerance of LocalPosition. On ties, the one drawn last by the last paint, which is on top.
+	bool FindLineAt(const FVector2f& LocalPosition, float Tolerance, FLineHit& OutHit) const;
+	// Lines with any part inside LocalRect, sorted by index.
+	TArray<int32> FindLinesInRect(const FBox2f& LocalRect) const;
+
 	TArray<int32> GetAllLines() const;
 	const FLineDescriptor* GetLine(int32 LineIndex);
+	// Points the geometry of the line is built from in local space: the samples of its curve, which are only there once a paint
+	// sampled it, or its polyline or streaming points. Those of the shape for instances, before the transform of the instance.
+	TConstArrayView<FVector2f> GetLinePoints(int32 LineIndex) const;
 	UMaterialInstanceDynamic* GetOrCreateMaterialInstanceOfLine(int32 LineIndex);
 
+	// Logs the lines of every drawer with the highest estimated cost, see r.LineDrawerDumpExpensiveLines.
+	static void DumpExpensiveLines(int32 NumLinesToDump, FOutputDevice& Ar);
+
+	struct FMemoryReport
+	{
+		int32 NumLines = 0;
+		int32 NumPooledBuffers = 0;
+		SIZE_T LineDataBytes = 0;
+		SIZE_T KeyPointBytes = 0;
+		SIZE_T SamplePointBytes = 0;
+		SIZE_T RenderDataBytes = 0;
+		SIZE_T DrawBatchBytes = 0;
+		SIZE_T BufferPoolBytes = 0;
+		// Allocated but unused part of the per line buffers, what Compact can give back besides the pool.
+		SIZE_T SlackBytes = 0;
+
+		SIZE_T GetTotalBytes() const { return LineDataBytes + KeyPointBytes + SamplePointBytes + RenderDataBytes + DrawBatchBytes + BufferPoolBytes; }
+	};
+
+	// Compact binary copy of the lines with their samples, so opening a large diagram doesn't sample every curve again. Each kind of
+	// data is one plain array behind a fixed header, loading copies them in bulk and Data can be a memory mapped file. Data aligned
+	// to 16 bytes, like any TArray or mapping, is read in place, other Data is copied first. bWithGeometry also saves the local
+	// space geometry, which the first paint reuses at a similar DrawScale instead of triangulating. Loading replaces all lines, with
+	// the indices they were saved with. Lines saved before they were sampled, or by a build that samples curves differently, are
+	// sampled on the next paint like new lines, and so are the lines updated afterwards with a curve that changed since. The arrays
+	// are in native byte order. Returns false, keeping the lines, for a blob of another version, byte order or type sizes, one
+	// that fails validation, or one with more than 64 line slots per line past the first 1024, as the holes between the saved
+	// line indices are allocated too. Streaming lines, shapes and their instances, and dynamic materials are not saved.
+	void SaveLinesSnapshot(TArray<uint8>& OutData, bool bWithGeometry = false) const;
+	bool LoadLinesSnapshot(TConstArrayView<uint8> Data);
+
+	// Frees the buffers pooled from removed lines and the slack of the buffers of the remaining lines.
+	void Compact();
+	FMemoryReport GetMemoryReport() const;
+	// Logs the memory report of every drawer, see r.LineDrawerMemReport.
+	static void DumpMemoryReport(FOutputDevice& Ar);
+
 protected:
 	virtual SWidget& GetLineDrawerWidget() = 0;
 
 	void AddLineDrawerReferencedObjects(FReferenceCollector& Collector) const;
-	int32 DrawLines(const FGeometry& AllottedGeometry, FSlateWindowElementList& OutDrawElements, int32 LayerId) const;
+	int32 DrawLines(const FGeometry& AllottedGeometry, const FSlateRect& CullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId) const;
+	// Vertices of the draw elements made by the last DrawLines.
+	int32 GetNumDrawnVertices() const { return NumDrawnVertices; }
 
 private:
 	struct FRenderData
+	{
+		// Local space positions of VertexData, kept as separate components so the transform pass can run on whole registers.
+		TArray<float> LocalPositionX;
+		TArray<float> LocalPositionY;
+		TArray<FSlateVertex> VertexData;
+		TArray<SlateIndex> IndexData;
+		FSlateResourceHandle RenderingResourceHandle;
+		const UObject* ResourceObject = nullptr;
+		FName ResourceName;
+		bool bHasDynamicMaterial = false;
+		FColor VertexColor;
+		// Where the line was drawn by the last paint, when DrawBatchesVersion is current. Streaming lines are drawn after the batches,
+		// each as a batch of its own.
+		int32 DrawBatchIndex = INDEX_NONE;
+		int32 DrawBatchFirstVertex = 0;
+		uint32 DrawBatchesVersion = 0;
+	};
+
+	struct FDrawBatch
 	{
 		TArray<FSlateVertex> VertexData;
 		TArray<SlateIndex> IndexData;
 		FSlateResourceHandle RenderingResourceHandle;
 	};
 
+	enum class ESpatialGridState : uint8
+	{
+		None,
+		InCells,
+		Oversized
+	};
+
+	// Points before HeadPoint were trimmed. They are kept until enough of them piled up to compact the storage in one go, so trimming
+	// the head doesn't shift the live points and geometry every frame.
+	struct FStreamingLine
+	{
+		int32 Capacity = 0;
+		int32 HeadPoint = 0;
+		// Points whose joins are built, the end cap of the line sits on the last of them.
+		int32 NumBuiltPoints = 0;
+		TArray<FVector2f> Points;
+		TArray<float> ArcLengths;
+		// Per point, the first vertex and index of the geometry of the segment starting at it, and whether it is joined to the
+		// previous segment with a miter rather than a pair of caps.
+		TArray<int32> FirstVertices;
+		TArray<int32> FirstIndices;
+		TArray<bool> MiterJoins;
+		// Start of the end cap, which is dropped when more points are appended.
+		int32 TailVertex = 0;
+		int32 TailIndex = 0;
+		// Geometry of the trimmed points. The dead indices are collapsed so nothing is drawn for them until they are compacted.
+		int32 NumDeadVertices = 0;
+		int32 NumDeadIndices = 0;
+	};
+
+	struct FLineInstance
+	{
+		int32 ShapeIndex = INDEX_NONE;
+		FSlateRenderTransform Transform;
+		FLinearColor Tint = FLinearColor::White;
+	};
+
+	// What the samples of a line were made from besides the keys. Compared exactly, so any change re-makes them.
+	struct FSampledCurveSettings
+	{
+		void Set(const FLineDescriptor& LineDescriptor);
+		bool Matches(const FLineDescriptor& LineDescriptor) const;
+
+		// Polyline buffers are never modified in place, a different buffer is a different line. A weak pointer can't match a new
+		// buffer allocated where a released one was.
+		TWeakPtr<const TArray<FVector2f>> PolylinePoints;
+		float InterpCurveStartT = 0.0f;
+		float InterpCurveEndT = 0.0f;
+		float Resolution = 0.0f;
+		float DynamicResolutionFactor = 0.0f;
+		float MaxResolution = 0.0f;
+		float TessellationTolerance = 0.0f;
+		float LoopKeyOffset = 0.0f;
+		ELineTessellationMode TessellationMode = ELineTessellationMode::Resolution;
+		bool bIsLooped = false;
+		// FCurveSamplingParams of the last full evaluation, which depend on the geometry and DrawScale the curve was sampled at.
+		// Dirty intervals are only re-sampled in place with the same ones.
+		float DynamicResolutionScale = 0.0f;
+		float LocalTolerance = 0.0f;
+	};
+
 	struct FLineData
 	{
 		FLineDescriptor LineDescriptor;
 		bool bNeedReEvalInterpCurve = false;
+		bool bNeedRebuildLocalGeometry = false;
+		bool bNeedUpdateSpatialGrid = false;
 		float LineLength = 0.0f;
+		float SampleDrawScale = 0.0f;
 		TArray<FVector2f> InterpCurveSamplePoints;
+		TArray<int32> IntervalSampleOffsets;
+		int32 FirstSampledKey = INDEX_NONE;
+		// Keys the samples were made from. A change is diffed against them, the keys that differ are re-sampled, or the whole curve
+		// without a range.
+		TArray<FInterpCurvePoint<FVector2f>> SampledKeys;
+		FSampledCurveSettings SampledCurveSettings;
+		int32 DirtyKeyBegin = INDEX_NONE;
+		int32 DirtyKeyEnd = INDEX_NONE;
+		FBox2f SampleBounds = FBox2f(ForceInit);
+		FIntRect SpatialGridCells;
+		ESpatialGridState SpatialGridState = ESpatialGridState::None;
 
 		FRenderData RenderData;
+		FSlateRenderTransform RenderDataTransform;
+		float LocalGeometryDrawScale = 0.0f;
+		float GeometryThickness = 0.0f;
+		// Points the geometry is built from when the line is decimated, with the DrawScale and settings they were made for.
+		TArray<FVector2f> DecimatedPoints;
+		// Bounds of every HitTestChunkSegments segments of the line points, built by the first hit test after the samples change.
+		TArray<FBox2f> SegmentChunkBounds;
+		float DecimationDrawScale = 0.0f;
+		ELineDecimationMode Decimation = ELineDecimationMode::None;
+		float DecimationTolerance = 0.0f;
+
+		uint32 Serial = 0;
+		// The handle the line was added for through the command queue, INDEX_NONE for the other lines.
+		int32 LineHandle = INDEX_NONE;
+		uint32 DataGeneration = 0;
+		uint64 StaleSinceFrame = MAX_uint64;
+		bool bTessellationInFlight = false;
+		TUniquePtr<FStreamingLine> Streaming;
+		// Instances keep only their transformed vertices, the local positions and indices are those of the shape.
+		TUniquePtr<FLineInstance> Instance;
 	};
 	mutable TSparseArray<FLineData> LineDatas;
+	TArray<int32> StreamingLines;
+
+	// Never in the spatial grid or the batches, only tessellated while they have instances.
+	struct FLineShape
+	{
+		FLineData LineData;
+		TArray<int32> Instances;
+	};
+	mutable TSparseArray<FLineShape> LineShapes;
+
+	// The lines of a drawer subscribed to LineSource only hold their geometry for this view, the samples are read from the source.
+	// The source flags the lines that changed in PendingSourceLines of each view, they are picked up when the view is painted.
+	ILineDrawer* LineSource = nullptr;
+	TArray<ILineDrawer*> LineViews;
+	mutable TBitArray<> PendingSourceLines;
+
+	enum class ELineCommand : uint8
+	{
+		Add,
+		Update,
+		Remove,
+		Release
+	};
+
+	struct FLineCommand
+	{
+		ELineCommand Command;
+		int32 LineHandle;
+		FLineDescriptor LineDescriptor;
+	};
+
+	TMpscQueue<FLineCommand> LineCommands;
+	TArray<FLineCommand> DrainedLineCommands;
+	TArray<int32> LineCommandOrder;
+	// Only the handles with a line, erasing a line removes its handle.
+	TMap<int32, int32> HandleLines;
+	TArray<int32> FreeLineHandles;
+	std::atomic<int32> NextLineHandle = 0;
+	// Taken on the game thread by ReserveLineHandles, producers only copy it.
+	TWeakPtr<SWidget> LineCommandsWidget;
+	std::atomic<bool> bLineCommandsInvalidationPending = false;
+
+	struct FLineWorkItem
+	{
+		int32 Index;
+		uint32 Cost;
+	};
+	mutable TArray<FLineWorkItem> LineWorkItems;
+	mutable TArray<FDrawBatch> DrawBatches;
+	// Streaming lines grow on every append, so each of them is drawn from its own render data rather than copied into a batch.
+	mutable TArray<int32> VisibleStreamingLines;
+	mutable bool bDrawBatchesDirty = true;
+	mutable uint32 DrawBatchesVersion = 0;
+	mutable int32 NumDrawnVertices = 0;
+
+	struct FLineSpatialGrid
+	{
+		void UpdateLine(int32 LineIndex, FLineData& InOutLineData);
+		void RemoveLine(int32 LineIndex, FLineData& InOutLineData);
+		void Reset();
+		// InOutVisitedLines is scratch space kept by the caller across queries, it is all clear again when the query returns.
+		void Query(const FBox2f& QueryBounds, int32 MaxLineIndex, TBitArray<>& InOutVisitedLines, TArray<int32>& OutLineIndices) const;
+		FIntRect GetCellRange(const FBox2f& Bounds) const;
+
+		static constexpr int32 MaxCellsPerLine = 64;
+
+		TMap<FIntPoint, TArray<int32>> Cells;
+		TArray<int32> OversizedLines;
+		float CellSize = 256.0f;
+	};
+	mutable FLineSpatialGrid SpatialGrid;
+
+	// Per line state read for every visible line on every paint, kept in dense arrays so the paint loop doesn't pull the
+	// descriptors and buffers of LineDatas into cache. Removal moves the last slot into the hole, LineSlots maps line indices to slots.
+	struct FLineHotStore
+	{
+		void Add(int32 LineIndex);
+		void Remove(int32 LineIndex);
+		void Reset();
+		void Shrink();
+		void MarkRenderDataStale(int32 LineIndex) { RenderDataCurrent[LineSlots[LineIndex]] = false; }
+		SIZE_T GetAllocatedSize() const;
+
+		TArray<int32> LineSlots;
+		TArray<int32> SlotLines;
+		// Bounds and padding the line is culled with, updated together with its cells in the spatial grid.
+		TArray<FBox2f> CullBounds;
+		TArray<float> PixelPaddings;
+		// Set once the render data of the line is found to match RenderTransform and DrawScale, cleared whenever the line changes.
+		TArray<bool> RenderDataCurrent;
+		FSlateRenderTransform RenderTransform;
+		float DrawScale = 0.0f;
+	};
+	mutable FLineHotStore HotStore;
+
+	// Buffers of removed lines and of finished tessellation jobs, reused by the next lines of a similar size so adding,
+	// removing and re-tessellating lines doesn't go back to the allocator for every buffer.
+	struct FLineBufferPool
+	{
+		void Release(FLineData& InOutLineData);
+		void Acquire(FLineData& InOutLineData, int32 ExpectedNumSamples);
+		void Empty();
+		int32 Num() const;
+
+		static SIZE_T GetAllocatedSize(const FLineData& LineData);
+
+		struct FLineBuffers
+		{
+			TArray<FVector2f> InterpCurveSamplePoints;
+			TArray<int32> IntervalSampleOffsets;
+			TArray<float> LocalPositionX;
+			TArray<float> LocalPositionY;
+			TArray<FSlateVertex> VertexData;
+			TArray<SlateIndex> IndexData;
+		};
+
+		// Buffer sets by the power of two size class of their sample capacity.
+		static constexpr int32 NumSizeClasses = 24;
+		TArray<FLineBuffers> SizeClasses[NumSizeClasses];
+		SIZE_T AllocatedSize = 0;
+	};
+	mutable FLineBufferPool BufferPool;
+	mutable TArray<int32> PendingInterpCurveLines;
+	mutable TArray<int32> VisibleLines;
+	mutable TArray<int32> PrevVisibleLines;
+	mutable TArray<int32> HitTestLines;
+	mutable TBitArray<> SpatialQueryVisitedLines;
+	mutable float MaxLinePixelPadding = 0.0f;
+	uint32 NextLineSerial = 0;
+
+	// Lines tessellated off the paint thread. The snapshots are the back buffers, they are swapped into LineDatas once the task is done.
+	struct FTessellationJob
+	{
+		TArray<int32> LineIndices;
+		TArray<uint32> LineSerials;
+		TArray<uint32> LineGenerations;
+		TArray<FLineData> LineSnapshots;
+		UE::Tasks::FTask Task;
+	};
+	mutable TArray<TSharedRef<FTessellationJob>> TessellationJobs;
+	mutable FGeometry LastAllottedGeometry;
+	mutable float LastDrawScale = 0.0f;
+
+	void ReserveLines(int32 NumLinesToAdd);
+	int32 EmplaceLine(FLineDescriptor&& LineDescriptor);
+	void MarkLineDirty(int32 LineIndex);
+	void MarkLineChanged(int32 LineIndex);
+	static void UpdateDirtyKeyRange(FLineData& InOutLineData);
+	static bool IsCurveSampled(const FLineData& LineData);
+	static void SetSampledCurve(FLineData& InOutLineData);
+	void PatchLineVertexColor(FLineData& InOutLineData) const;
+	static FColor GetLineVertexColor(const FLineDescriptor& LineDescriptor);
+	bool EraseLine(int32 LineIndex);
+	void InvalidateLineDrawer();
+	void NotifyLineViews(int32 LineIndex) const;
+	void UpdateFromLineSource() const;
+	void RequestLineViewsRepaint() const;
+	bool EnsureNotLineView() const;
+	void EnqueueLineCommand(ELineCommand Command, int32 LineHandle, FLineDescriptor&& LineDescriptor);
+	bool ApplyLineCommands();
+	static void CopyLineStyle(const FLineDescriptor& SourceDescriptor, FLineDescriptor& OutLineDescriptor);
+
+	void EvalPendingLineInterpCurves(const FGeometry& AllottedGeometry, float DrawScale) const;
+	void KickTessellationJobs() const;
+	void ApplyFinishedTessellationJobs(const FSlateRenderTransform& RenderTransform, bool bWaitForAll) const;
+	void UpdateTessellationStats() const;
+	void UpdateStreamingLines(const FGeometry& AllottedGeometry, const FSlateRenderTransform& RenderTransform, float DrawScale) const;
+	void UpdateLineShapes(const FGeometry& AllottedGeometry, float DrawScale) const;
+	void UpdateLineInstanceBounds(int32 LineIndex) const;
+	static void SetLineInstanceDescriptor(const FLineDescriptor& ShapeDescriptor, const FLineInstance& Instance, FLineDescriptor& OutLineDescriptor);
+	static FBox2f TransformBounds(const FBox2f& Bounds, const FSlateRenderTransform& Transform);
+	static void PublishFrameCounters();
+	static SIZE_T GetRenderDataAllocatedSize(const FRenderData& RenderData);
+	void UpdateLineSpatialGrid(int32 LineIndex) const;
+	static uint32 EstimateLineCost(const FLineData& LineData, bool bNeedReEval, bool bNeedRebuild);
+	static void ParallelForLines(const TCHAR* DebugName, TArray<FLineWorkItem>& WorkItems, TFunctionRef<void(int32 Index)> Body);
+	bool GatherVisibleLines(const FSlateRect& CullingRect, const FSlateRenderTransform& RenderTransform, float DrawScale) const;
+	void RebuildDrawBatches() const;
+	// Lines drawn later compare greater, lines not drawn by the last paint compare lowest.
+	uint64 GetLineDrawOrder(const FLineData& LineData) const;
+
+	enum class ERenderDataUpdate : uint8
+	{
+		None,
+		Transformed,
+		Rebuilt
+	};
+
+	ERenderDataUpdate UpdateLineInstanceRenderData(FLineData& InOutLineData, const FSlateRenderTransform& RenderTransform) const;
+	ERenderDataUpdate UpdateMirroredLineRenderData(int32 LineIndex, FLineData& InOutLineData, const FSlateRenderTransform& RenderTransform, float DrawScale) const;
+
+	struct FCurveSamplingParams
+	{
+		FCurveSamplingParams(const FLineDescriptor& LineDescriptor, const FGeometry& AllottedGeometry, float DrawScale);
+
+		const float DynamicResolutionScale;
+		const float LocalTolerance;
+	};
+
+	static void EvalLineInterpCurve(FLineData& InOutLineData, const FGeometry& AllottedGeometry, float DrawScale);
+	static bool ReEvalDirtyKeyIntervals(FLineData& InOutLineData, const FGeometry& AllottedGeometry, float DrawScale);
+	static float GetPolylineLength(TConstArrayView<FVector2f> Points);
+	static TConstArrayView<FBox2f> GetSegmentChunkBounds(FLineData& InOutLineData);
+	static float GetLineHitT(const FLineData& LineData, int32 SegmentIndex, float SegmentAlpha);
+	static bool SegmentIntersectsBox(const FVector2f& SegmentStart, const FVector2f& SegmentEnd, const FBox2f& Box);
+	static constexpr int32 HitTestChunkSegments = 32;
+	// Points the geometry of the line is built from, the samples of its curve or the points of a polyline.
+	static TConstArrayView<FVector2f> GetLinePoints(const FLineData& LineData);
+	struct FHermiteSegment
+	{
+		FHermiteSegment(const FInterpCurve<FVector2f>& InterpCurve, int32 KeyIndex);
+
+		// As FInterpCurve::Eval walks a curve: a looped curve has one more interval, from its last key back to its first over
+		// LoopKeyOffset. The curve must have keys.
+		static int32 GetNumIntervals(const FInterpCurve<FVector2f>& InterpCurve);
+		static float GetIntervalEndT(const FInterpCurve<FVector2f>& InterpCurve, int32 KeyIndex);
+		static float GetCurveEndT(const FInterpCurve<FVector2f>& InterpCurve) { return GetIntervalEndT(InterpCurve, InterpCurve.Points.Num() - 1); }
+
+		bool IsCurve() const { return InterpMode == CIM_CurveUser; }
+		FVector2f Eval(float T) const;
+		FVector2f EvalDerivative(float T) const;
+		FVector2f EvalSecondDerivative(float T) const;
+		void EvalPoints(TConstArrayView<float> EvalTValues, FVector2f* OutPoints) const;
+
+		float StartT = 0.0f;
+		// Input value of the next key, StartT for the last key of a curve that isn't looped.
+		float EndT = 0.0f;
+		float InvDeltaT = 0.0f;
+		EInterpCurveMode InterpMode = CIM_Constant;
+		FVector2f A = FVector2f::ZeroVector;
+		FVector2f B = FVector2f::ZeroVector;
+		FVector2f C = FVector2f::ZeroVector;
+		FVector2f D = FVector2f::ZeroVector;
+	};
 
-	static void UpdateLineRenderData(FLineData& InOutLineData, const FGeometry& AllottedGeometry);
+	static void SampleKeyInterval(const FLineDescriptor& LineDescriptor, const FHermiteSegment& Segment, float IntervalStartT, float IntervalEndT, const FCurveSamplingParams& SamplingParams, TArray<float, TInlineAllocator<64>>& OutEvalTValues);
+	static void SubdivideKeyInterval(const FHermiteSegment& Segment, float StartT, const FVector2f& StartPoint, const FVector2f& StartTangent, float EndT, const FVector2f& EndPoint, const FVector2f& EndTangent, float LocalToleranceSq, int32 Depth, TArray<float, TInlineAllocator<64>>& OutEvalTValues);
+	static float GetPointSegmentDistanceSq(const FVector2f& Point, const FVector2f& SegmentStart, const FVector2f& SegmentEnd);
+	static bool NeedReEvalForDrawScale(const FLineData& LineData, float DrawScale);
+	static ERenderDataUpdate UpdateLineRenderData(FLineData& InOutLineData, const FGeometry& AllottedGeometry, const FSlateRenderTransform& RenderTransform, float DrawScale, bool bDeferRebuild);
+	static bool IsRenderDataUpToDate(const FLineData& LineData, const FSlateRenderTransform& RenderTransform, float DrawScale);
+	static void TessellateLine(FLineData& InOutLineData, const FGeometry& AllottedGeometry, float DrawScale);
+	static void BuildLocalGeometry(FLineData& InOutLineData, float DrawScale);
+	static void BuildLocalGeometry(FLineData& InOutLineData, float DrawScale, TConstArrayView<FVector2f> LinePoints, float LineLength);
+	static float GetLinePixelPadding(const FLineDescriptor& LineDescriptor);
+	static bool NeedRebuildLocalGeometry(const FLineData& LineData, float DrawScale);
+	// Whether the geometry of the line was built with the decimation settings of the descriptor. The tolerance only counts in
+	// Tolerance mode.
+	static bool IsSameDecimation(const FLineData& LineData, const FLineDescriptor& LineDescriptor);
+	static void SetDecimation(FLineData& InOutLineData, const FLineDescriptor& LineDescriptor);
+	static bool NeedDecimateForDrawScale(const FLineData& LineData, float DrawScale);
+	static void DecimateLinePoints(TConstArrayView<FVector2f> Points, const FLineDescriptor& LineDescriptor, float DrawScale, TArray<FVector2f>& OutPoints);
+	static void DecimateMinMaxPerPixel(TConstArrayView<FVector2f> Points, float ColumnsPerUnit, TArray<FVector2f>& OutPoints);
+	static void DecimateDouglasPeucker(TConstArrayView<FVector2f> Points, float ToleranceSq, TArray<FVector2f>& OutPoints);
+	static void TransformRenderData(FRenderData& InOutRenderData, const FSlateRenderTransform& RenderTransform, ESlateVertexRounding Rounding, int32 FirstVertex = 0, int32 NumVerticesToTransform = INDEX_NONE);
+	static void TransformVertices(const float* LocalX, const float* LocalY, FSlateVertex* Vertices, int32 NumVertices, const FSlateRenderTransform& RenderTransform, ESlateVertexRounding Rounding);
+
+	static void BuildStreamingGeometry(FLineData& InOutLineData, float DrawScale);
+	static void ExtendStreamingGeometry(FLineData& InOutLineData, int32& OutFirstNewVertex, int32& OutHeadCapVertex);
+	static void TrimStreamingHead(FLineData& InOutLineData, int32 NewHeadPoint, int32& OutHeadCapVertex);
+	static void CompactStreamingLine(FLineData& InOutLineData, bool bForce);
 
 	struct FLineBuilder
 	{
-		FLineBuilder(FRenderData& RenderData, const FSlateRenderTransform& RenderTransform, float ElementScale, float HalfThickness, float FilterRadius, float MiterAngleLimit);
+		FLineBuilder(FRenderData& RenderData, float ElementScale, float HalfThickness, float FilterRadius, float MiterAngleLimit);
 
-		void BuildLineGeometry(const TArray<FVector2f>& Points, float InLineLength, const FColor& PointColor, ESlateVertexRounding Rounding);
-		void MakeStartCap(const FVector2f Position, const FVector2f Direction, float SegmentLength, const FVector2f Up, const FColor& Color, ESlateVertexRounding Rounding);
-		void MakeEndCap(const FVector2f Position, const FVector2f Direction, float SegmentLength, const FVector2f Up, const FColor& Color, ESlateVertexRounding Rounding);
+		void BuildLineGeometry(TConstArrayView<FVector2f> Points, float InLineLength, const FColor& PointColor);
+		void BuildStreamingGeometry(FStreamingLine& Stream, const FColor& PointColor);
+		bool AddJoin(const FVector2f Position, const FVector2f LastDirection, float LastLength, const FVector2f LastUp, const FVector2f Direction, float SegmentLength, const FVector2f Up, const FColor& Color);
+		void MakeStartCap(const FVector2f Position, const FVector2f Direction, float SegmentLength, const FVector2f Up, const FColor& Color);
+		void MakeEndCap(const FVector2f Position, const FVector2f Direction, float SegmentLength, const FVector2f Up, const FColor& Color);
+		void AddVertex(const FVector2f LocalPosition, const FVector2f TexCoord, const FVector2f TexCoord2, const FColor& Color);
 
 		static void AddQuadIndices(FRenderData& InRenderData);
 		static FVector2f GetMiterNormal(const FVector2f InboundSegmentDir, const FVector2f OutboundSegmentDir);
 
 		FRenderData& RenderData;
-		const FSlateRenderTransform& RenderTransform;
 
 		const float LocalHalfThickness;
 		const float LocalFilterRadius;
@@ -58,8 +58,11 @@ struct FLineWithAutoTangent
 	FLineDescriptor LineDescriptor;
 
 	int32 LineIndex = INDEX_NONE;
+	// Hash of what WritePointsToLineDescriptor last wrote the curve from, to skip rewriting it when only the descriptor changed.
+	uint32 PointsHash = 0;
 
 	void WritePointsToLineDescriptor(const FSplineTangentSettings& TangentSettings = FSplineTangentSettings());
+	uint32 GetPointsHash(const FSplineTangentSettings& TangentSettings) const;
 };
 
 /**
@@ -0,0 +1,31 @@
+﻿// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+public class AdvancedLineDrawerEditor : ModuleRules
+{
+	public AdvancedLineDrawerEditor(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Core",
+			}
+			);
+
+
+		PrivateDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"AdvancedLineDrawer",
+				"CoreUObject",
+				"Engine",
+				"Json",
+				"Slate",
+				"SlateCore",
+			}
+			);
+	}
+}
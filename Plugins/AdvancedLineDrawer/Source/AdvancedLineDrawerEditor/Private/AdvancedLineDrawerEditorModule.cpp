@@ -0,0 +1,13 @@
+﻿// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Modules/ModuleManager.h"
+
+// Development only: the benchmark commandlet and the automation tests of the line drawer.
+class FAdvancedLineDrawerEditorModule : public IModuleInterface
+{
+public:
+	virtual void StartupModule() override {}
+	virtual void ShutdownModule() override {}
+};
+
+IMPLEMENT_MODULE(FAdvancedLineDrawerEditorModule, AdvancedLineDrawerEditor)
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HeadlessLineDrawer.h"
+
+#include "Rendering/DrawElements.h"
+
+int32 SHeadlessLineDrawer::Paint(const FGeometry& AllottedGeometry, const FSlateRect& CullingRect)
+{
+	ElementList.ResetElementList();
+	DrawLines(AllottedGeometry, CullingRect, ElementList, 0);
+	return GetNumDrawnVertices();
+}
+
+void SetCurvePointsWithAutoTangentsScalar(FLineDescriptor& OutLineDescriptor, const TArray<FVector2f>& Points, float InterpStartT, float InterpEndT, EInterpCurveMode InterpMode, const FSplineTangentSettings& TangentSettings)
+{
+	TArray<FInterpCurvePoint<FVector2f>>& Keys = OutLineDescriptor.InterpCurve.Points;
+	const int32 NumPoints = Points.Num();
+	Keys.SetNumUninitialized(NumPoints);
+	FVector2f NextArriveTangent = FVector2f::Zero();
+	for (int32 Index = 0; Index < NumPoints; ++Index)
+	{
+		const FVector2f& CurrentPoint = Points[Index];
+		const float InterpT = FMath::Lerp(InterpStartT, InterpEndT, NumPoints > 1 ? static_cast<float>(Index) / (NumPoints - 1) : 1.0f);
+
+		if (Index < NumPoints - 1)
+		{
+			const FVector2f DeltaPos = Points[Index + 1] - CurrentPoint;
+			if (InterpMode == CIM_Linear)
+			{
+				Keys[Index] = FInterpCurvePoint(InterpT, CurrentPoint, NextArriveTangent, DeltaPos, InterpMode);
+				NextArriveTangent = -DeltaPos;
+				continue;
+			}
+			const float ClampedTensionX = FMath::Min<float>(FMath::Abs<float>(DeltaPos.X), TangentSettings.SplineHorizontalDeltaRange);
+			const float ClampedTensionY = FMath::Min<float>(FMath::Abs<float>(DeltaPos.Y), TangentSettings.SplineVerticalDeltaRange);
+			const FVector2f SplineTangent = (ClampedTensionX * TangentSettings.SplineTangentFromHorizontalDelta + ClampedTensionY * TangentSettings.SplineTangentFromVerticalDelta) * FVector2f(FMath::Sign(DeltaPos.X), FMath::Sign(DeltaPos.Y));
+
+			Keys[Index] = FInterpCurvePoint(InterpT, CurrentPoint, NextArriveTangent, SplineTangent, InterpMode);
+			NextArriveTangent = TangentSettings.bTranspose ? FVector2f(-SplineTangent.Y, DeltaPos.X > 0 ? SplineTangent.X : -SplineTangent.X) : FVector2f(SplineTangent.X, -SplineTangent.Y);
+		}
+		else
+		{
+			Keys[Index] = FInterpCurvePoint(InterpT, CurrentPoint, NextArriveTangent, FVector2f::Zero(), InterpMode);
+		}
+	}
+}
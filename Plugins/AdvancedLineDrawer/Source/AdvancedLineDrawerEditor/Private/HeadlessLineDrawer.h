@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LineDrawer.h"
+#include "Widgets/SLeafWidget.h"
+
+/**
+ * Line drawer that is never added to a window, the benchmark and the tests paint it directly.
+ */
+class SHeadlessLineDrawer : public SLeafWidget, public ILineDrawer
+{
+public:
+	SLATE_BEGIN_ARGS(SHeadlessLineDrawer)
+	{}
+
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& InArgs) {}
+
+	// Paints the lines into a fresh element list and returns the number of vertices drawn.
+	int32 Paint(const FGeometry& AllottedGeometry, const FSlateRect& CullingRect);
+
+protected:
+	//~ Begin ILineDrawer Interface
+	virtual SWidget& GetLineDrawerWidget() override { return *this; }
+	//~ End ILineDrawer Interface
+
+	//~ Begin SLeafWidget Interface
+	virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override { return LayerId; }
+	virtual FVector2D ComputeDesiredSize(float) const override { return FVector2D::ZeroVector; }
+	//~ End SLeafWidget Interface
+
+private:
+	FSlateWindowElementList ElementList = FSlateWindowElementList(nullptr);
+};
+
+// One key at a time, the way SetCurvePointsWithAutoTangents wrote the keys before it was batched. It must write the same bits.
+void SetCurvePointsWithAutoTangentsScalar(FLineDescriptor& OutLineDescriptor, const TArray<FVector2f>& Points, float InterpStartT, float InterpEndT, EInterpCurveMode InterpMode, const FSplineTangentSettings& TangentSettings);
@@ -0,0 +1,730 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LineDrawerBenchmarkCommandlet.h"
+
+#include "HeadlessLineDrawer.h"
+#include "Algo/Sort.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+#include "Serialization/JsonWriter.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogLineDrawerBenchmark, Log, All);
+
+// What a stage allocates outside the scopes the drawer tags as its own, mostly on the game thread.
+LLM_DEFINE_TAG(LineDrawerBenchmark);
+
+class FLineDrawerBenchmark
+{
+public:
+	struct FCase
+	{
+		FString Workload;
+		int32 NumLines = 0;
+		int32 NumKeys = 0;
+		FString Mode;
+		float Thickness = 2.0f;
+		float Scale = 1.0f;
+	};
+
+	struct FResult
+	{
+		FCase Case;
+		FString Threading;
+		FString Stage;
+		int32 Iterations = 0;
+		double NsPerIteration = 0.0;
+		double NsPerLine = 0.0;
+		double VerticesPerSecond = 0.0;
+		// Vertices of the last iteration, those drawn for the paint stages.
+		int32 NumVertices = 0;
+		// Net growth of the memory LLM tracks under the tags of the drawer and of the benchmark, 0 unless run with -llm.
+		double TrackedBytesPerIteration = 0.0;
+	};
+
+	FLineDrawerBenchmark(int32 InIterations, int32 InHeavyKeys);
+	~FLineDrawerBenchmark();
+
+	void RunCase(const FCase& Case, TArray<FResult>& OutResults);
+	int32 GetNumFailedChecks() const { return NumFailedChecks; }
+
+	static FString ToCsv(TConstArrayView<FResult> Results);
+	static FString ToJson(TConstArrayView<FResult> Results);
+	// Logs the vertices drawn at ScreenSpaceTolerance against the Resolution heuristic for the cases run in both modes.
+	static void LogTessellationModeComparison(TConstArrayView<FResult> Results);
+
+private:
+	TArray<FLineDescriptor> MakeLineDescriptors(const FCase& Case) const;
+	int32 Draw(const FCase& Case) const;
+	void Check(bool bCondition, const FString& Message);
+	static int64 GetTrackedBytes();
+
+	template <typename SetupFuncType, typename RunFuncType>
+	void Measure(const FCase& Case, const TCHAR* Threading, const TCHAR* Stage, SetupFuncType&& Setup, RunFuncType&& Run, TArray<FResult>& OutResults);
+
+	struct FThreadingMode
+	{
+		const TCHAR* Name;
+		bool bForceSingleThread;
+		bool bCostBalancedScheduling;
+	};
+	static constexpr FThreadingMode ThreadingModes[] = {
+		{ TEXT("SingleThread"), true, false },
+		{ TEXT("Parallel"), false, false },
+		{ TEXT("ParallelCostBalanced"), false, true },
+	};
+
+	static constexpr int32 NumWarmupIterations = 2;
+	static inline const FVector2D ViewportSize = FVector2D(1920.0, 1080.0);
+
+	const int32 Iterations;
+	const int32 HeavyKeys;
+	TSharedRef<SHeadlessLineDrawer> Drawer;
+	float PanOffset = 0.0f;
+	int32 NumFailedChecks = 0;
+
+	IConsoleVariable* ForceSingleThreadCVar;
+	IConsoleVariable* CostBalancedSchedulingCVar;
+	IConsoleVariable* AsyncTessellationCVar;
+	bool bSavedForceSingleThread;
+	bool bSavedCostBalancedScheduling;
+	bool bSavedAsyncTessellation;
+};
+
+FLineDrawerBenchmark::FLineDrawerBenchmark(int32 InIterations, int32 InHeavyKeys) :
+	Iterations(InIterations),
+	HeavyKeys(InHeavyKeys),
+	Drawer(SNew(SHeadlessLineDrawer))
+{
+	IConsoleManager& ConsoleManager = IConsoleManager::Get();
+	ForceSingleThreadCVar = ConsoleManager.FindConsoleVariable(TEXT("r.LineDrawerForceSingleThread"));
+	CostBalancedSchedulingCVar = ConsoleManager.FindConsoleVariable(TEXT("r.LineDrawerCostBalancedScheduling"));
+	AsyncTessellationCVar = ConsoleManager.FindConsoleVariable(TEXT("r.LineDrawerAsyncTessellation"));
+	check(ForceSingleThreadCVar && CostBalancedSchedulingCVar && AsyncTessellationCVar);
+	bSavedForceSingleThread = ForceSingleThreadCVar->GetBool();
+	bSavedCostBalancedScheduling = CostBalancedSchedulingCVar->GetBool();
+	bSavedAsyncTessellation = AsyncTessellationCVar->GetBool();
+	AsyncTessellationCVar->Set(false, ECVF_SetByCode);
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+	if (!FLowLevelMemTracker::IsEnabled())
+#endif
+	{
+		UE_LOG(LogLineDrawerBenchmark, Display, TEXT("Run with -llm to fill TrackedBytesPerIteration"));
+	}
+}
+
+FLineDrawerBenchmark::~FLineDrawerBenchmark()
+{
+	ForceSingleThreadCVar->Set(bSavedForceSingleThread, ECVF_SetByCode);
+	CostBalancedSchedulingCVar->Set(bSavedCostBalancedScheduling, ECVF_SetByCode);
+	AsyncTessellationCVar->Set(bSavedAsyncTessellation, ECVF_SetByCode);
+}
+
+void FLineDrawerBenchmark::RunCase(const FCase& Case, TArray<FResult>& OutResults)
+{
+	const TArray<FLineDescriptor> LineDescriptors = MakeLineDescriptors(Case);
+	ILineDrawer& LineDrawer = *Drawer;
+
+	TArray<TArray<FVector2f>> LinePoints;
+	LinePoints.Reserve(LineDescriptors.Num());
+	for (const FLineDescriptor& LineDescriptor : LineDescriptors)
+	{
+		TArray<FVector2f>& Points = LinePoints.AddDefaulted_GetRef();
+		for (const FInterpCurvePoint<FVector2f>& Key : LineDescriptor.InterpCurve.Points)
+		{
+			Points.Add(Key.OutVal);
+		}
+	}
+	const EInterpCurveMode AutoTangentMode = Case.Mode == TEXT("Linear") ? CIM_Linear : CIM_CurveUser;
+	TArray<FLineDescriptor> AutoTangentDescriptors;
+	AutoTangentDescriptors.SetNum(LineDescriptors.Num());
+
+	for (const FThreadingMode& ThreadingMode : ThreadingModes)
+	{
+		ForceSingleThreadCVar->Set(ThreadingMode.bForceSingleThread, ECVF_SetByCode);
+		CostBalancedSchedulingCVar->Set(ThreadingMode.bCostBalancedScheduling, ECVF_SetByCode);
+
+		Measure(Case, ThreadingMode.Name, TEXT("SetCurvePointsWithAutoTangents.Scalar"), []() {}, [&]()
+		{
+			for (int32 Index = 0; Index < LinePoints.Num(); ++Index)
+			{
+				SetCurvePointsWithAutoTangentsScalar(AutoTangentDescriptors[Index], LinePoints[Index], 0.0f, 1.0f, AutoTangentMode, FSplineTangentSettings());
+			}
+			return 0;
+		}, OutResults);
+
+		TArray<FLineDescriptor> BatchedDescriptors;
+		BatchedDescriptors.SetNum(LineDescriptors.Num());
+		Measure(Case, ThreadingMode.Name, TEXT("SetCurvePointsWithAutoTangents.Batched"), []() {}, [&]()
+		{
+			for (int32 Index = 0; Index < LinePoints.Num(); ++Index)
+			{
+				BatchedDescriptors[Index].SetCurvePointsWithAutoTangents(LinePoints[Index], 0.0f, 1.0f, AutoTangentMode, FSplineTangentSettings());
+			}
+			return 0;
+		}, OutResults);
+
+		for (int32 Index = 0; Index < LinePoints.Num(); ++Index)
+		{
+			const TArray<FInterpCurvePoint<FVector2f>>& ScalarKeys = AutoTangentDescriptors[Index].InterpCurve.Points;
+			const TArray<FInterpCurvePoint<FVector2f>>& BatchedKeys = BatchedDescriptors[Index].InterpCurve.Points;
+			for (int32 KeyIndex = 0; KeyIndex < ScalarKeys.Num(); ++KeyIndex)
+			{
+				const FInterpCurvePoint<FVector2f>& ScalarKey = ScalarKeys[KeyIndex];
+				const FInterpCurvePoint<FVector2f>& BatchedKey = BatchedKeys[KeyIndex];
+				if (FMemory::Memcmp(&ScalarKey.InVal, &BatchedKey.InVal, sizeof(float)) != 0 || FMemory::Memcmp(&ScalarKey.OutVal, &BatchedKey.OutVal, sizeof(FVector2f)) != 0
+					|| FMemory::Memcmp(&ScalarKey.ArriveTangent, &BatchedKey.ArriveTangent, sizeof(FVector2f)) != 0 || FMemory::Memcmp(&ScalarKey.LeaveTangent, &BatchedKey.LeaveTangent, sizeof(FVector2f)) != 0
+					|| ScalarKey.InterpMode != BatchedKey.InterpMode)
+				{
+					Check(false, FString::Printf(TEXT("Batched auto tangents differ from the scalar ones at key %d of line %d"), KeyIndex, Index));
+					break;
+				}
+			}
+		}
+
+		TArray<FLineDescriptor> LineDescriptorsToAdd;
+		Measure(Case, ThreadingMode.Name, TEXT("AddLines"), [&]()
+		{
+			LineDrawer.RemoveAllLines();
+			LineDescriptorsToAdd = LineDescriptors;
+		}, [&]()
+		{
+			LineDrawer.AddLines(MoveTemp(LineDescriptorsToAdd));
+			return 0;
+		}, OutResults);
+
+		const TArray<int32> AllLines = LineDrawer.GetAllLines();
+		Draw(Case);
+
+		Measure(Case, ThreadingMode.Name, TEXT("DrawLines.Full"), [&]()
+		{
+			LineDrawer.UpdateLines(AllLines, [](int32, FLineDescriptor&) { return true; });
+		}, [&]() { return Draw(Case); }, OutResults);
+
+		float DragOffset = 4.0f;
+		Measure(Case, ThreadingMode.Name, TEXT("DrawLines.PointDrag"), [&]()
+		{
+			DragOffset = -DragOffset;
+			LineDrawer.UpdateLines(AllLines, [DragOffset](int32, FLineDescriptor& OutLineDescriptor)
+			{
+				const int32 PointIndex = OutLineDescriptor.InterpCurve.Points.Num() / 2;
+				OutLineDescriptor.SetPoint(PointIndex, OutLineDescriptor.InterpCurve.Points[PointIndex].OutVal + FVector2f(0.0f, DragOffset));
+				return true;
+			});
+		}, [&]() { return Draw(Case); }, OutResults);
+
+		Measure(Case, ThreadingMode.Name, TEXT("DrawLines.Pan"), [&]()
+		{
+			PanOffset += 1.0f;
+		}, [&]() { return Draw(Case); }, OutResults);
+		PanOffset = 0.0f;
+
+		Measure(Case, ThreadingMode.Name, TEXT("DrawLines.Idle"), []() {}, [&]() { return Draw(Case); }, OutResults);
+
+		// Mouse move hit tests over a grid of positions, NsPerIteration is the cost of all of them.
+		constexpr int32 NumHitTestsPerAxis = 32;
+		Measure(Case, ThreadingMode.Name, TEXT("FindLineAt"), []() {}, [&]()
+		{
+			int32 NumHits = 0;
+			ILineDrawer::FLineHit Hit;
+			for (int32 Y = 0; Y < NumHitTestsPerAxis; ++Y)
+			{
+				for (int32 X = 0; X < NumHitTestsPerAxis; ++X)
+				{
+					const FVector2f Position(ViewportSize.X * (X + 0.5f) / NumHitTestsPerAxis, ViewportSize.Y * (Y + 0.5f) / NumHitTestsPerAxis);
+					NumHits += LineDrawer.FindLineAt(Position, 4.0f / Case.Scale, Hit) ? 1 : 0;
+				}
+			}
+			return NumHits;
+		}, OutResults);
+
+		Measure(Case, ThreadingMode.Name, TEXT("FindLinesInRect"), []() {}, [&]()
+		{
+			return LineDrawer.FindLinesInRect(FBox2f(FVector2f(ViewportSize.X * 0.4f, ViewportSize.Y * 0.4f), FVector2f(ViewportSize.X * 0.6f, ViewportSize.Y * 0.6f))).Num();
+		}, OutResults);
+
+		// Every other line removed leaves holes all over the line storage, the idle paint should cost about half of the dense one.
+		TArray<int32> RemovedLines;
+		TArray<FLineDescriptor> RemovedLineDescriptors;
+		for (int32 Index = 1; Index < AllLines.Num(); Index += 2)
+		{
+			RemovedLines.Add(AllLines[Index]);
+			RemovedLineDescriptors.Add(*LineDrawer.GetLine(AllLines[Index]));
+		}
+		LineDrawer.RemoveLines(RemovedLines);
+		Draw(Case);
+		Measure(Case, ThreadingMode.Name, TEXT("DrawLines.IdleSparse"), []() {}, [&]() { return Draw(Case); }, OutResults);
+		LineDrawer.AddLines(MoveTemp(RemovedLineDescriptors));
+		Draw(Case);
+
+		// Every line re-triangulated from the samples it already has, then moved into the widget.
+		float ThicknessOffset = 0.5f;
+		Measure(Case, ThreadingMode.Name, TEXT("DrawLines.Thickness"), [&]()
+		{
+			ThicknessOffset = -ThicknessOffset;
+			LineDrawer.UpdateLines(AllLines, [&Case, ThicknessOffset](int32, FLineDescriptor& OutLineDescriptor)
+			{
+				OutLineDescriptor.Thickness = Case.Thickness + ThicknessOffset;
+				return true;
+			});
+		}, [&]() { return Draw(Case); }, OutResults);
+
+		// Opening a saved diagram up to its first paint, from the descriptors against from a snapshot of the drawer.
+		Draw(Case);
+		TArray<uint8> Snapshot;
+		LineDrawer.SaveLinesSnapshot(Snapshot);
+		TArray<uint8> SnapshotWithGeometry;
+		LineDrawer.SaveLinesSnapshot(SnapshotWithGeometry, true);
+		UE_LOG(LogLineDrawerBenchmark, Display, TEXT("Snapshot %.1f KB, with geometry %.1f KB"), Snapshot.Num() / 1024.0, SnapshotWithGeometry.Num() / 1024.0);
+		Measure(Case, ThreadingMode.Name, TEXT("Load.Cold"), [&]()
+		{
+			LineDrawer.RemoveAllLines();
+			LineDescriptorsToAdd = LineDescriptors;
+		}, [&]()
+		{
+			LineDrawer.AddLines(MoveTemp(LineDescriptorsToAdd));
+			return Draw(Case);
+		}, OutResults);
+
+		Measure(Case, ThreadingMode.Name, TEXT("Load.Snapshot"), [&]() { LineDrawer.RemoveAllLines(); }, [&]()
+		{
+			Check(LineDrawer.LoadLinesSnapshot(Snapshot), TEXT("Snapshot failed to load"));
+			return Draw(Case);
+		}, OutResults);
+
+		Measure(Case, ThreadingMode.Name, TEXT("Load.SnapshotWithGeometry"), [&]() { LineDrawer.RemoveAllLines(); }, [&]()
+		{
+			Check(LineDrawer.LoadLinesSnapshot(SnapshotWithGeometry), TEXT("Snapshot with geometry failed to load"));
+			return Draw(Case);
+		}, OutResults);
+
+		// Producers on the workers adding, updating, removing and adding back the lines through the command queue while the game
+		// thread keeps painting. Each line is edited by two producers at once, both end every other line with a remove and the
+		// others with an add, so whichever of their last commands is enqueued last, the line must exist or not as they ended it,
+		// with the descriptor of one of the two final adds.
+		constexpr int32 NumUpdatesPerLine = 4;
+		const int32 NumProducers = FMath::Max(FPlatformMisc::NumberOfWorkerThreadsToSpawn(), 2);
+		const TArray<int32> StressHandles = LineDrawer.ReserveLineHandles(FMath::Max(LineDescriptors.Num(), 1));
+		auto GetProducerLines = [&LineDescriptors, NumProducers](int32 Producer)
+		{
+			return TPair<int32, int32>(LineDescriptors.Num() * Producer / NumProducers, LineDescriptors.Num() * (Producer + 1) / NumProducers);
+		};
+		// Above the thickness of the updates, and different for each producer.
+		auto GetFinalThickness = [&Case](int32 Producer) { return Case.Thickness + 2.0f + Producer; };
+		auto CheckStressLines = [&]()
+		{
+			int32 NumMismatchedLines = 0;
+			for (int32 Producer = 0; Producer < NumProducers; ++Producer)
+			{
+				const auto [Begin, End] = GetProducerLines(Producer);
+				const int32 OtherProducer = (Producer + NumProducers - 1) % NumProducers;
+				for (int32 Index = Begin; Index < End; ++Index)
+				{
+					const int32 LineIndex = LineDrawer.GetLineOfHandle(StressHandles[Index]);
+					const FLineDescriptor* LineDescriptor = LineIndex != INDEX_NONE ? LineDrawer.GetLine(LineIndex) : nullptr;
+					const bool bRemoved = Index % 2 == 1;
+					const bool bMatches = bRemoved ? !LineDescriptor
+						: LineDescriptor && (LineDescriptor->Thickness == GetFinalThickness(Producer) || LineDescriptor->Thickness == GetFinalThickness(OtherProducer));
+					NumMismatchedLines += bMatches ? 0 : 1;
+				}
+			}
+			Check(NumMismatchedLines == 0, FString::Printf(TEXT("%d lines don't match the last command enqueued for them"), NumMismatchedLines));
+		};
+
+		bool bStressRan = false;
+		Measure(Case, ThreadingMode.Name, TEXT("LineCommands.Stress"), [&]()
+		{
+			if (bStressRan)
+			{
+				CheckStressLines();
+			}
+			LineDrawer.RemoveAllLines();
+			Draw(Case);
+		}, [&]()
+		{
+			std::atomic<int32> NumProducersDone = 0;
+			TArray<UE::Tasks::FTask> Producers;
+			for (int32 Producer = 0; Producer < NumProducers; ++Producer)
+			{
+				Producers.Add(UE::Tasks::Launch(UE_SOURCE_LOCATION, [&, Producer]()
+				{
+					// The lines of this producer, then those of the next one.
+					for (const int32 LinesOf : { Producer, (Producer + 1) % NumProducers })
+					{
+						const auto [Begin, End] = GetProducerLines(LinesOf);
+						for (int32 Index = Begin; Index < End; ++Index)
+						{
+							LineDrawer.EnqueueAddLine(StressHandles[Index], FLineDescriptor(LineDescriptors[Index]));
+						}
+						for (int32 Update = 1; Update <= NumUpdatesPerLine; ++Update)
+						{
+							for (int32 Index = Begin; Index < End; ++Index)
+							{
+								FLineDescriptor LineDescriptor = LineDescriptors[Index];
+								LineDescriptor.Thickness = Case.Thickness + 0.25f * Update;
+								LineDrawer.EnqueueUpdateLine(StressHandles[Index], MoveTemp(LineDescriptor));
+							}
+						}
+						for (int32 Index = Begin; Index < End; ++Index)
+						{
+							LineDrawer.EnqueueRemoveLine(StressHandles[Index]);
+							FLineDescriptor LineDescriptor = LineDescriptors[Index];
+							LineDescriptor.Thickness = GetFinalThickness(Producer);
+							LineDrawer.EnqueueAddLine(StressHandles[Index], MoveTemp(LineDescriptor));
+							if (Index % 2 == 1)
+							{
+								LineDrawer.EnqueueRemoveLine(StressHandles[Index]);
+							}
+						}
+					}
+					NumProducersDone.fetch_add(1);
+				}));
+			}
+
+			int32 NumVertices = 0;
+			while (NumProducersDone.load() < NumProducers)
+			{
+				NumVertices += Draw(Case);
+			}
+			UE::Tasks::Wait(Producers);
+			bStressRan = true;
+			return NumVertices + Draw(Case);
+		}, OutResults);
+		CheckStressLines();
+
+		// Released handles remove their lines and are handed out again instead of new ones.
+		for (const int32 LineHandle : StressHandles)
+		{
+			LineDrawer.EnqueueReleaseLineHandle(LineHandle);
+		}
+		LineDrawer.FlushLineCommands();
+		Check(LineDrawer.GetAllLines().Num() == 0, TEXT("Releasing the handles of the stress stage left lines behind"));
+		TArray<int32> RecycledHandles = LineDrawer.ReserveLineHandles(StressHandles.Num());
+		TArray<int32> SortedStressHandles = StressHandles;
+		Algo::Sort(RecycledHandles);
+		Algo::Sort(SortedStressHandles);
+		Check(RecycledHandles == SortedStressHandles, TEXT("Released line handles weren't handed out again"));
+		for (const int32 LineHandle : RecycledHandles)
+		{
+			LineDrawer.EnqueueReleaseLineHandle(LineHandle);
+		}
+		LineDrawer.FlushLineCommands();
+
+		// The same number of lines as instances of the first one, placed where the first key of each line is. A full update
+		// tessellates the shape once and only copies and transforms it for every instance, compare with DrawLines.Full.
+		LineDrawer.RemoveAllLines();
+		const int32 ShapeIndex = LineDrawer.AddLineShape(FLineDescriptor(LineDescriptors[0]));
+		const FVector2f ShapeOrigin = LineDescriptors[0].InterpCurve.Points.Num() > 0 ? LineDescriptors[0].InterpCurve.Points[0].OutVal : FVector2f::ZeroVector;
+		for (const FLineDescriptor& LineDescriptor : LineDescriptors)
+		{
+			const FVector2f Origin = LineDescriptor.InterpCurve.Points.Num() > 0 ? LineDescriptor.InterpCurve.Points[0].OutVal : FVector2f::ZeroVector;
+			LineDrawer.AddLineInstance(ShapeIndex, FSlateRenderTransform(Origin - ShapeOrigin));
+		}
+		Draw(Case);
+
+		Measure(Case, ThreadingMode.Name, TEXT("DrawLines.InstancedFull"), [&]()
+		{
+			LineDrawer.UpdateLineShape(ShapeIndex, [](FLineDescriptor&) { return true; });
+		}, [&]() { return Draw(Case); }, OutResults);
+		LineDrawer.RemoveLineShape(ShapeIndex);
+	}
+
+	LineDrawer.RemoveAllLines();
+}
+
+template <typename SetupFuncType, typename RunFuncType>
+void FLineDrawerBenchmark::Measure(const FCase& Case, const TCHAR* Threading, const TCHAR* Stage, SetupFuncType&& Setup, RunFuncType&& Run, TArray<FResult>& OutResults)
+{
+	for (int32 Iteration = 0; Iteration < NumWarmupIterations; ++Iteration)
+	{
+		Setup();
+		Run();
+	}
+
+	uint64 TotalCycles = 0;
+	uint64 TotalVertices = 0;
+	int32 NumVertices = 0;
+	int64 TotalTrackedBytes = 0;
+	for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		Setup();
+
+		const int64 StartTrackedBytes = GetTrackedBytes();
+		{
+			LLM_SCOPE_BYTAG(LineDrawerBenchmark);
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			NumVertices = Run();
+			TotalVertices += NumVertices;
+			TotalCycles += FPlatformTime::Cycles64() - StartCycles;
+		}
+		TotalTrackedBytes += GetTrackedBytes() - StartTrackedBytes;
+	}
+
+	const double TotalSeconds = FPlatformTime::ToSeconds64(TotalCycles);
+	FResult& Result = OutResults.AddDefaulted_GetRef();
+	Result.Case = Case;
+	Result.Threading = Threading;
+	Result.Stage = Stage;
+	Result.Iterations = Iterations;
+	Result.NsPerIteration = TotalSeconds * 1e9 / Iterations;
+	Result.NsPerLine = Result.NsPerIteration / FMath::Max(Drawer->GetAllLines().Num(), 1);
+	Result.VerticesPerSecond = TotalSeconds > 0.0 ? TotalVertices / TotalSeconds : 0.0;
+	Result.NumVertices = NumVertices;
+	Result.TrackedBytesPerIteration = static_cast<double>(TotalTrackedBytes) / Iterations;
+
+	UE_LOG(LogLineDrawerBenchmark, Display, TEXT("%s %d lines x %d keys %s T%.1f S%.2f [%s] %s: %.0f ns/line, %.3g verts/s, %.0f bytes"),
+		*Case.Workload, Case.NumLines, Case.NumKeys, *Case.Mode, Case.Thickness, Case.Scale, Threading, Stage, Result.NsPerLine, Result.VerticesPerSecond, Result.TrackedBytesPerIteration);
+}
+
+TArray<FLineDescriptor> FLineDrawerBenchmark::MakeLineDescriptors(const FCase& Case) const
+{
+	// Seeded from the case so every run of the same case draws the same lines.
+	FRandomStream RandomStream(GetTypeHash(Case.Workload) ^ (Case.NumLines * 31 + Case.NumKeys));
+	const bool bLinear = Case.Mode == TEXT("Linear");
+
+	TArray<FLineDescriptor> LineDescriptors;
+	LineDescriptors.SetNum(Case.NumLines);
+	TArray<FVector2f> Points;
+	for (int32 LineIndex = 0; LineIndex < Case.NumLines; ++LineIndex)
+	{
+		// The skewed workload mixes a few very long traces into short links, the way node graphs with a timeline do.
+		const int32 NumKeys = Case.Workload == TEXT("Skewed") ? (LineIndex % 20 == 0 ? HeavyKeys : 2) : Case.NumKeys;
+		const FVector2f Start(RandomStream.FRandRange(0.0f, ViewportSize.X * 0.8f), RandomStream.FRandRange(0.0f, ViewportSize.Y));
+		const float Step = ViewportSize.X * 0.2f / FMath::Max(NumKeys - 1, 1);
+		Points.Reset();
+		for (int32 KeyIndex = 0; KeyIndex < NumKeys; ++KeyIndex)
+		{
+			Points.Add(Start + FVector2f(KeyIndex * Step, RandomStream.FRandRange(-40.0f, 40.0f)));
+		}
+
+		FLineDescriptor& LineDescriptor = LineDescriptors[LineIndex];
+		LineDescriptor.SetCurvePointsWithAutoTangents(Points, 0.0f, 1.0f, bLinear ? CIM_Linear : CIM_CurveUser);
+		LineDescriptor.Thickness = Case.Thickness;
+		if (Case.Mode == TEXT("Tolerance"))
+		{
+			LineDescriptor.TessellationMode = ELineTessellationMode::ScreenSpaceTolerance;
+		}
+		else if (Case.Mode.StartsWith(TEXT("Polyline")))
+		{
+			LineDescriptor.SetPolylinePoints(CopyTemp(Points));
+			if (Case.Mode == TEXT("PolylineMinMax"))
+			{
+				LineDescriptor.Decimation = ELineDecimationMode::MinMaxPerPixel;
+			}
+			else if (Case.Mode == TEXT("PolylineTolerance"))
+			{
+				LineDescriptor.Decimation = ELineDecimationMode::Tolerance;
+			}
+		}
+	}
+	return LineDescriptors;
+}
+
+int32 FLineDrawerBenchmark::Draw(const FCase& Case) const
+{
+	const FGeometry Geometry = FGeometry::MakeRoot(ViewportSize, FSlateLayoutTransform(Case.Scale, FVector2f(PanOffset, 0.0f)));
+	return Drawer->Paint(Geometry, FSlateRect(0.0f, 0.0f, ViewportSize.X, ViewportSize.Y));
+}
+
+void FLineDrawerBenchmark::Check(bool bCondition, const FString& Message)
+{
+	if (!bCondition)
+	{
+		UE_LOG(LogLineDrawerBenchmark, Error, TEXT("%s"), *Message);
+		++NumFailedChecks;
+	}
+}
+
+int64 FLineDrawerBenchmark::GetTrackedBytes()
+{
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+	if (FLowLevelMemTracker::IsEnabled())
+	{
+		// The amounts of the workers are only gathered by the per frame update.
+		FLowLevelMemTracker& Tracker = FLowLevelMemTracker::Get();
+		Tracker.UpdateStatsPerFrame();
+		return Tracker.GetTagAmountForTracker(ELLMTracker::Default, FName(TEXT("LineDrawer")), ELLMTagSet::None)
+			+ Tracker.GetTagAmountForTracker(ELLMTracker::Default, FName(TEXT("LineDrawerBenchmark")), ELLMTagSet::None);
+	}
+#endif
+	return 0;
+}
+
+FString FLineDrawerBenchmark::ToCsv(TConstArrayView<FResult> Results)
+{
+	FString Csv = TEXT("Workload,Lines,Keys,Mode,Thickness,Scale,Threading,Stage,Iterations,NsPerIteration,NsPerLine,VerticesPerSecond,Vertices,TrackedBytesPerIteration\n");
+	for (const FResult& Result : Results)
+	{
+		Csv += FString::Printf(TEXT("%s,%d,%d,%s,%g,%g,%s,%s,%d,%.1f,%.1f,%.1f,%d,%.1f\n"),
+			*Result.Case.Workload, Result.Case.NumLines, Result.Case.NumKeys, *Result.Case.Mode, Result.Case.Thickness, Result.Case.Scale,
+			*Result.Threading, *Result.Stage, Result.Iterations, Result.NsPerIteration, Result.NsPerLine, Result.VerticesPerSecond, Result.NumVertices, Result.TrackedBytesPerIteration);
+	}
+	return Csv;
+}
+
+FString FLineDrawerBenchmark::ToJson(TConstArrayView<FResult> Results)
+{
+	FString Json;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	Writer->WriteArrayStart();
+	for (const FResult& Result : Results)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("Workload"), Result.Case.Workload);
+		Writer->WriteValue(TEXT("Lines"), Result.Case.NumLines);
+		Writer->WriteValue(TEXT("Keys"), Result.Case.NumKeys);
+		Writer->WriteValue(TEXT("Mode"), Result.Case.Mode);
+		Writer->WriteValue(TEXT("Thickness"), Result.Case.Thickness);
+		Writer->WriteValue(TEXT("Scale"), Result.Case.Scale);
+		Writer->WriteValue(TEXT("Threading"), Result.Threading);
+		Writer->WriteValue(TEXT("Stage"), Result.Stage);
+		Writer->WriteValue(TEXT("Iterations"), Result.Iterations);
+		Writer->WriteValue(TEXT("NsPerIteration"), Result.NsPerIteration);
+		Writer->WriteValue(TEXT("NsPerLine"), Result.NsPerLine);
+		Writer->WriteValue(TEXT("VerticesPerSecond"), Result.VerticesPerSecond);
+		Writer->WriteValue(TEXT("Vertices"), Result.NumVertices);
+		Writer->WriteValue(TEXT("TrackedBytesPerIteration"), Result.TrackedBytesPerIteration);
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+	Writer->Close();
+	return Json;
+}
+
+void FLineDrawerBenchmark::LogTessellationModeComparison(TConstArrayView<FResult> Results)
+{
+	for (const FResult& Tolerance : Results)
+	{
+		if (Tolerance.Case.Mode != TEXT("Tolerance") || Tolerance.Stage != TEXT("DrawLines.Idle"))
+		{
+			continue;
+		}
+
+		const FResult* Resolution = Results.FindByPredicate([&Tolerance](const FResult& Result)
+		{
+			return Result.Case.Mode == TEXT("Curve") && Result.Stage == Tolerance.Stage && Result.Threading == Tolerance.Threading && Result.Case.Workload == Tolerance.Case.Workload
+				&& Result.Case.NumLines == Tolerance.Case.NumLines && Result.Case.NumKeys == Tolerance.Case.NumKeys && Result.Case.Thickness == Tolerance.Case.Thickness && Result.Case.Scale == Tolerance.Case.Scale;
+		});
+		if (Resolution && Resolution->NumVertices > 0)
+		{
+			UE_LOG(LogLineDrawerBenchmark, Display, TEXT("%s %d lines x %d keys T%.1f S%.2f [%s]: %d vertices at ScreenSpaceTolerance, %d at Resolution (%.2fx)"),
+				*Tolerance.Case.Workload, Tolerance.Case.NumLines, Tolerance.Case.NumKeys, Tolerance.Case.Thickness, Tolerance.Case.Scale, *Tolerance.Threading,
+				Tolerance.NumVertices, Resolution->NumVertices, static_cast<double>(Tolerance.NumVertices) / Resolution->NumVertices);
+		}
+	}
+}
+
+ULineDrawerBenchmarkCommandlet::ULineDrawerBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 ULineDrawerBenchmarkCommandlet::Main(const FString& Params)
+{
+	auto ParseList = [&Params](const TCHAR* Key, const TCHAR* Default)
+	{
+		FString Value;
+		if (!FParse::Value(*Params, Key, Value, false))
+		{
+			Value = Default;
+		}
+
+		TArray<FString> Items;
+		Value.ParseIntoArray(Items, TEXT(","));
+		return Items;
+	};
+
+	const TArray<FString> NumLinesList = ParseList(TEXT("Lines="), TEXT("1000,10000"));
+	const TArray<FString> NumKeysList = ParseList(TEXT("Keys="), TEXT("4,64"));
+	const TArray<FString> Modes = ParseList(TEXT("Modes="), TEXT("Linear,Curve,Tolerance,Polyline"));
+	const TArray<FString> ThicknessList = ParseList(TEXT("Thickness="), TEXT("1,4"));
+	const TArray<FString> ScaleList = ParseList(TEXT("Scale="), TEXT("1,2"));
+	int32 Iterations = 10;
+	int32 HeavyKeys = 2000;
+	int32 DensePoints = 1000000;
+	FParse::Value(*Params, TEXT("Iterations="), Iterations);
+	FParse::Value(*Params, TEXT("HeavyKeys="), HeavyKeys);
+	FParse::Value(*Params, TEXT("DensePoints="), DensePoints);
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("LineDrawerBenchmark") / TEXT("Results.csv");
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	TArray<FLineDrawerBenchmark::FResult> Results;
+	int32 NumFailedChecks = 0;
+	{
+		FLineDrawerBenchmark Benchmark(FMath::Max(Iterations, 1), FMath::Max(HeavyKeys, 2));
+		for (const FString& NumLines : NumLinesList)
+		{
+			FLineDrawerBenchmark::FCase Case;
+			Case.NumLines = FCString::Atoi(*NumLines);
+			Case.Thickness = FCString::Atof(*ThicknessList[0]);
+			Case.Scale = FCString::Atof(*ScaleList[0]);
+
+			Case.Workload = TEXT("Uniform");
+			for (const FString& NumKeys : NumKeysList)
+			{
+				Case.NumKeys = FCString::Atoi(*NumKeys);
+				for (const FString& Mode : Modes)
+				{
+					Case.Mode = Mode;
+					for (const FString& Thickness : ThicknessList)
+					{
+						Case.Thickness = FCString::Atof(*Thickness);
+						for (const FString& Scale : ScaleList)
+						{
+							Case.Scale = FCString::Atof(*Scale);
+							Benchmark.RunCase(Case, Results);
+						}
+					}
+				}
+			}
+
+			Case.Workload = TEXT("Skewed");
+			Case.NumKeys = HeavyKeys;
+			Case.Mode = TEXT("Curve");
+			Case.Thickness = FCString::Atof(*ThicknessList[0]);
+			Case.Scale = FCString::Atof(*ScaleList[0]);
+			Benchmark.RunCase(Case, Results);
+		}
+
+		// A single time series with far more points than pixels, drawn as is and decimated.
+		if (DensePoints > 0)
+		{
+			FLineDrawerBenchmark::FCase Case;
+			Case.Workload = TEXT("Dense");
+			Case.NumLines = 1;
+			Case.NumKeys = FMath::Max(DensePoints, 2);
+			Case.Thickness = FCString::Atof(*ThicknessList[0]);
+			Case.Scale = FCString::Atof(*ScaleList[0]);
+			for (const TCHAR* Mode : { TEXT("Polyline"), TEXT("PolylineMinMax"), TEXT("PolylineTolerance") })
+			{
+				Case.Mode = Mode;
+				Benchmark.RunCase(Case, Results);
+			}
+		}
+		NumFailedChecks = Benchmark.GetNumFailedChecks();
+	}
+
+	FLineDrawerBenchmark::LogTessellationModeComparison(Results);
+
+	const bool bJson = FPaths::GetExtension(OutputPath).Equals(TEXT("json"), ESearchCase::IgnoreCase);
+	const FString Output = bJson ? FLineDrawerBenchmark::ToJson(Results) : FLineDrawerBenchmark::ToCsv(Results);
+	if (!FFileHelper::SaveStringToFile(Output, *OutputPath))
+	{
+		UE_LOG(LogLineDrawerBenchmark, Error, TEXT("Failed to write the results to %s"), *OutputPath);
+		return 1;
+	}
+
+	UE_LOG(LogLineDrawerBenchmark, Display, TEXT("Wrote %d results to %s"), Results.Num(), *OutputPath);
+	if (NumFailedChecks > 0)
+	{
+		UE_LOG(LogLineDrawerBenchmark, Error, TEXT("%d checks failed"), NumFailedChecks);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "LineDrawerBenchmarkCommandlet.generated.h"
+
+/**
+ * Headless benchmark of the line drawing pipeline. Writes one CSV or JSON row per workload, threading mode and stage, and returns
+ * non-zero when any of its correctness checks fails. Pass -llm for the memory column.
+ *
+ * UnrealEditor-Cmd <Project> -run=LineDrawerBenchmark -nullrhi [-llm] [-Lines=1000,10000] [-Keys=4,64] [-Modes=Linear,Curve,Tolerance,Polyline]
+ *     [-Thickness=1,4] [-Scale=1,2] [-HeavyKeys=2000] [-DensePoints=1000000] [-Iterations=10] [-Output=<path>.csv|.json]
+ */
+UCLASS()
+class ULineDrawerBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	ULineDrawerBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
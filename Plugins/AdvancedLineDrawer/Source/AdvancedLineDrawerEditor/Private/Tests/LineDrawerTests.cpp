@@ -0,0 +1,401 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "HeadlessLineDrawer.h"
+#include "Algo/Compare.h"
+#include "Algo/Reverse.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace LineDrawerTests
+{
+	static const FVector2D ViewportSize(1920.0, 1080.0);
+
+	static int32 Paint(SHeadlessLineDrawer& Drawer, float Scale = 1.0f)
+	{
+		return Drawer.Paint(FGeometry::MakeRoot(ViewportSize, FSlateLayoutTransform(Scale)), FSlateRect(0.0f, 0.0f, ViewportSize.X, ViewportSize.Y));
+	}
+
+	static TArray<FVector2f> MakeRandomPoints(FRandomStream& RandomStream, int32 NumPoints)
+	{
+		TArray<FVector2f> Points;
+		Points.Reserve(NumPoints);
+		for (int32 Index = 0; Index < NumPoints; ++Index)
+		{
+			// Some repeated X too, for the zero deltas whose sign is 0.
+			const float X = Index > 0 && RandomStream.RandRange(0, 3) == 0 ? Points.Last().X : Index * 4.0f;
+			Points.Add(FVector2f(X, RandomStream.FRandRange(-200.0f, 200.0f)));
+		}
+		return Points;
+	}
+
+	static float GetDistanceToPolyline(const FVector2f& Point, TConstArrayView<FVector2f> Polyline)
+	{
+		float MinDistanceSq = Polyline.Num() > 0 ? FVector2f::DistSquared(Point, Polyline[0]) : MAX_flt;
+		for (int32 Index = 1; Index < Polyline.Num(); ++Index)
+		{
+			const FVector2f SegmentDelta = Polyline[Index] - Polyline[Index - 1];
+			const float SegmentLengthSq = SegmentDelta.SizeSquared();
+			const float Alpha = SegmentLengthSq > SMALL_NUMBER ? FMath::Clamp(FVector2f::DotProduct(Point - Polyline[Index - 1], SegmentDelta) / SegmentLengthSq, 0.0f, 1.0f) : 0.0f;
+			MinDistanceSq = FMath::Min(MinDistanceSq, FVector2f::DistSquared(Point, Polyline[Index - 1] + SegmentDelta * Alpha));
+		}
+		return FMath::Sqrt(MinDistanceSq);
+	}
+
+	static FLineDescriptor MakeCurve(TConstArrayView<FInterpCurvePoint<FVector2f>> Keys, ELineTessellationMode TessellationMode)
+	{
+		FLineDescriptor LineDescriptor;
+		LineDescriptor.InterpCurve.Points = TArray<FInterpCurvePoint<FVector2f>>(Keys.GetData(), Keys.Num());
+		LineDescriptor.InterpCurveStartT = Keys[0].InVal;
+		LineDescriptor.InterpCurveEndT = Keys.Last().InVal;
+		LineDescriptor.TessellationMode = TessellationMode;
+		return LineDescriptor;
+	}
+
+	// Paints the curve and compares its samples with FInterpCurve::Eval stepped finely enough to stand for the curve itself: every
+	// sample must lie on the curve, and with bCheckChordError every point of the curve must be within MaxChordError of the samples.
+	static void TestSamplesMatchEval(FAutomationTestBase& Test, const TCHAR* What, const FLineDescriptor& LineDescriptor, bool bCheckChordError, float MaxChordError)
+	{
+		TSharedRef<SHeadlessLineDrawer> Drawer = SNew(SHeadlessLineDrawer);
+		const int32 LineIndex = Drawer->AddLine(LineDescriptor);
+		Paint(*Drawer);
+		const TConstArrayView<FVector2f> Samples = Drawer->GetLinePoints(LineIndex);
+		if (!Test.TestTrue(FString::Printf(TEXT("%s is sampled"), What), Samples.Num() >= 2))
+		{
+			return;
+		}
+
+		constexpr int32 NumReferencePoints = 20000;
+		const FInterpCurve<FVector2f>& InterpCurve = LineDescriptor.InterpCurve;
+		TArray<FVector2f> Reference;
+		Reference.Reserve(NumReferencePoints + 1);
+		for (int32 Index = 0; Index <= NumReferencePoints; ++Index)
+		{
+			Reference.Add(InterpCurve.Eval(FMath::Lerp(LineDescriptor.InterpCurveStartT, LineDescriptor.InterpCurveEndT, static_cast<float>(Index) / NumReferencePoints)));
+		}
+
+		constexpr float MaxSampleError = 0.05f;
+		float MaxSampleDistance = 0.0f;
+		for (const FVector2f& Sample : Samples)
+		{
+			MaxSampleDistance = FMath::Max(MaxSampleDistance, GetDistanceToPolyline(Sample, Reference));
+		}
+		Test.TestTrue(FString::Printf(TEXT("%s samples are on the curve (off by %f)"), What, MaxSampleDistance), MaxSampleDistance <= MaxSampleError);
+
+		if (bCheckChordError)
+		{
+			float MaxCurveDistance = 0.0f;
+			for (const FVector2f& Point : Reference)
+			{
+				MaxCurveDistance = FMath::Max(MaxCurveDistance, GetDistanceToPolyline(Point, Samples));
+			}
+			Test.TestTrue(FString::Printf(TEXT("%s samples follow the curve (off by %f)"), What, MaxCurveDistance), MaxCurveDistance <= MaxChordError + MaxSampleError);
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLineDrawerAutoTangentsTest, "Plugins.AdvancedLineDrawer.AutoTangents", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FLineDrawerAutoTangentsTest::RunTest(const FString& Parameters)
+{
+	FRandomStream RandomStream(0x11D);
+	FSplineTangentSettings TransposedSettings;
+	FSplineTangentSettings StraightSettings;
+	StraightSettings.bTranspose = false;
+	StraightSettings.SplineHorizontalDeltaRange = 50.0f;
+
+	// Past the size of a block, so the blocks written on the workers are covered too.
+	for (const int32 NumPoints : { 1, 2, 3, 7, 64, 40000 })
+	{
+		const TArray<FVector2f> Points = LineDrawerTests::MakeRandomPoints(RandomStream, NumPoints);
+		for (const EInterpCurveMode InterpMode : { CIM_Linear, CIM_CurveUser })
+		{
+			for (const FSplineTangentSettings* TangentSettings : { &TransposedSettings, &StraightSettings })
+			{
+				FLineDescriptor Batched;
+				FLineDescriptor Scalar;
+				Batched.SetCurvePointsWithAutoTangents(Points, 0.0f, 1.0f, InterpMode, *TangentSettings);
+				SetCurvePointsWithAutoTangentsScalar(Scalar, Points, 0.0f, 1.0f, InterpMode, *TangentSettings);
+
+				const TArray<FInterpCurvePoint<FVector2f>>& BatchedKeys = Batched.InterpCurve.Points;
+				const TArray<FInterpCurvePoint<FVector2f>>& ScalarKeys = Scalar.InterpCurve.Points;
+				if (!TestEqual(TEXT("Number of keys"), BatchedKeys.Num(), ScalarKeys.Num()))
+				{
+					return false;
+				}
+				for (int32 KeyIndex = 0; KeyIndex < ScalarKeys.Num(); ++KeyIndex)
+				{
+					const FInterpCurvePoint<FVector2f>& BatchedKey = BatchedKeys[KeyIndex];
+					const FInterpCurvePoint<FVector2f>& ScalarKey = ScalarKeys[KeyIndex];
+					const bool bSameBits = FMemory::Memcmp(&BatchedKey.InVal, &ScalarKey.InVal, sizeof(float)) == 0
+						&& FMemory::Memcmp(&BatchedKey.OutVal, &ScalarKey.OutVal, sizeof(FVector2f)) == 0
+						&& FMemory::Memcmp(&BatchedKey.ArriveTangent, &ScalarKey.ArriveTangent, sizeof(FVector2f)) == 0
+						&& FMemory::Memcmp(&BatchedKey.LeaveTangent, &ScalarKey.LeaveTangent, sizeof(FVector2f)) == 0
+						&& BatchedKey.InterpMode == ScalarKey.InterpMode;
+					if (!bSameBits)
+					{
+						AddError(FString::Printf(TEXT("Key %d of %d points differs from the scalar reference (mode %d, transpose %d)"), KeyIndex, NumPoints, static_cast<int32>(InterpMode), TangentSettings->bTranspose));
+						break;
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLineDrawerSamplesMatchEvalTest, "Plugins.AdvancedLineDrawer.SamplesMatchEval", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FLineDrawerSamplesMatchEvalTest::RunTest(const FString& Parameters)
+{
+	using namespace LineDrawerTests;
+
+	// Stepped curve: every key holds its value up to the next key, in both modes.
+	const FInterpCurvePoint<FVector2f> SteppedKeys[] = {
+		FInterpCurvePoint<FVector2f>(0.0f, FVector2f(100.0f, 100.0f), FVector2f::ZeroVector, FVector2f::ZeroVector, CIM_Constant),
+		FInterpCurvePoint<FVector2f>(1.0f, FVector2f(300.0f, 250.0f), FVector2f::ZeroVector, FVector2f::ZeroVector, CIM_Constant),
+		FInterpCurvePoint<FVector2f>(2.0f, FVector2f(500.0f, 50.0f), FVector2f::ZeroVector, FVector2f::ZeroVector, CIM_Constant),
+		FInterpCurvePoint<FVector2f>(3.0f, FVector2f(700.0f, 200.0f), FVector2f::ZeroVector, FVector2f::ZeroVector, CIM_Constant),
+	};
+	TestSamplesMatchEval(*this, TEXT("Stepped curve at Resolution"), MakeCurve(SteppedKeys, ELineTessellationMode::Resolution), true, 0.0f);
+	TestSamplesMatchEval(*this, TEXT("Stepped curve at ScreenSpaceTolerance"), MakeCurve(SteppedKeys, ELineTessellationMode::ScreenSpaceTolerance), true, 0.0f);
+
+	// The curve holds the first key until it jumps at the second one, so does a hit on the jump.
+	{
+		TSharedRef<SHeadlessLineDrawer> Drawer = SNew(SHeadlessLineDrawer);
+		Drawer->AddLine(MakeCurve(SteppedKeys, ELineTessellationMode::Resolution));
+		Paint(*Drawer);
+		ILineDrawer::FLineHit Hit;
+		const FVector2f JumpMidpoint = (SteppedKeys[0].OutVal + SteppedKeys[1].OutVal) * 0.5f;
+		TestTrue(TEXT("Hit on the jump of a held key"), Drawer->FindLineAt(JumpMidpoint, 1.0f, Hit));
+		TestEqual(TEXT("The jump is at the next key"), Hit.T, SteppedKeys[1].InVal);
+	}
+
+	// Broken tangents: the arrive tangent of the middle key differs from its leave tangent, which is zero. The subdivision must bound
+	// the first interval with the arrive tangent of the middle key, or it takes the interval for straight and keeps a single chord.
+	const FInterpCurvePoint<FVector2f> BrokenTangentKeys[] = {
+		FInterpCurvePoint<FVector2f>(0.0f, FVector2f(100.0f, 300.0f), FVector2f::ZeroVector, FVector2f(300.0f, 0.0f), CIM_CurveUser),
+		FInterpCurvePoint<FVector2f>(1.0f, FVector2f(300.0f, 300.0f), FVector2f(0.0f, 900.0f), FVector2f::ZeroVector, CIM_CurveUser),
+		FInterpCurvePoint<FVector2f>(2.0f, FVector2f(500.0f, 300.0f), FVector2f(300.0f, 0.0f), FVector2f::ZeroVector, CIM_CurveUser),
+	};
+	const FLineDescriptor BrokenTangentCurve = MakeCurve(BrokenTangentKeys, ELineTessellationMode::ScreenSpaceTolerance);
+	TestSamplesMatchEval(*this, TEXT("Broken tangents at ScreenSpaceTolerance"), BrokenTangentCurve, true, BrokenTangentCurve.TessellationTolerance);
+	TestSamplesMatchEval(*this, TEXT("Broken tangents at Resolution"), MakeCurve(BrokenTangentKeys, ELineTessellationMode::Resolution), false, 0.0f);
+
+	// Every interpolation mode in one curve, ending part way into a held interval.
+	const FInterpCurvePoint<FVector2f> MixedKeys[] = {
+		FInterpCurvePoint<FVector2f>(0.0f, FVector2f(100.0f, 500.0f), FVector2f::ZeroVector, FVector2f(200.0f, -200.0f), CIM_CurveUser),
+		FInterpCurvePoint<FVector2f>(0.5f, FVector2f(250.0f, 400.0f), FVector2f(200.0f, 200.0f), FVector2f::ZeroVector, CIM_Linear),
+		FInterpCurvePoint<FVector2f>(1.5f, FVector2f(450.0f, 600.0f), FVector2f::ZeroVector, FVector2f::ZeroVector, CIM_Constant),
+		FInterpCurvePoint<FVector2f>(2.0f, FVector2f(600.0f, 450.0f), FVector2f::ZeroVector, FVector2f::ZeroVector, CIM_Constant),
+		FInterpCurvePoint<FVector2f>(3.0f, FVector2f(800.0f, 500.0f), FVector2f::ZeroVector, FVector2f::ZeroVector, CIM_Constant),
+	};
+	FLineDescriptor MixedCurve = MakeCurve(MixedKeys, ELineTessellationMode::ScreenSpaceTolerance);
+	MixedCurve.InterpCurveEndT = 2.5f;
+	TestSamplesMatchEval(*this, TEXT("Mixed modes at ScreenSpaceTolerance"), MixedCurve, true, MixedCurve.TessellationTolerance);
+	MixedCurve.TessellationMode = ELineTessellationMode::Resolution;
+	TestSamplesMatchEval(*this, TEXT("Mixed modes at Resolution"), MixedCurve, false, 0.0f);
+
+	// Looped curve: the last key goes back to the first over LoopKeyOffset, which the samples must close with.
+	const FInterpCurvePoint<FVector2f> LoopedKeys[] = {
+		FInterpCurvePoint<FVector2f>(0.0f, FVector2f(300.0f, 100.0f), FVector2f(300.0f, 0.0f), FVector2f(300.0f, 0.0f), CIM_CurveUser),
+		FInterpCurvePoint<FVector2f>(1.0f, FVector2f(500.0f, 400.0f), FVector2f(-100.0f, 300.0f), FVector2f(-100.0f, 300.0f), CIM_CurveUser),
+		FInterpCurvePoint<FVector2f>(2.0f, FVector2f(100.0f, 400.0f), FVector2f(-100.0f, -300.0f), FVector2f(-100.0f, -300.0f), CIM_CurveUser),
+	};
+	FLineDescriptor LoopedCurve = MakeCurve(LoopedKeys, ELineTessellationMode::ScreenSpaceTolerance);
+	LoopedCurve.InterpCurve.bIsLooped = true;
+	LoopedCurve.InterpCurve.LoopKeyOffset = 1.0f;
+	LoopedCurve.InterpCurveEndT = 3.0f;
+	TestSamplesMatchEval(*this, TEXT("Looped curve at ScreenSpaceTolerance"), LoopedCurve, true, LoopedCurve.TessellationTolerance);
+	LoopedCurve.TessellationMode = ELineTessellationMode::Resolution;
+	TestSamplesMatchEval(*this, TEXT("Looped curve at Resolution"), LoopedCurve, false, 0.0f);
+	{
+		TSharedRef<SHeadlessLineDrawer> Drawer = SNew(SHeadlessLineDrawer);
+		const int32 LineIndex = Drawer->AddLine(LoopedCurve);
+		Paint(*Drawer);
+		const TConstArrayView<FVector2f> Samples = Drawer->GetLinePoints(LineIndex);
+		TestTrue(TEXT("Looped curve closes on its first key"), Samples.Num() > 0 && Samples.Last().Equals(LoopedKeys[0].OutVal, 0.05f));
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLineDrawerPartialResampleTest, "Plugins.AdvancedLineDrawer.PartialResample", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FLineDrawerPartialResampleTest::RunTest(const FString& Parameters)
+{
+	using namespace LineDrawerTests;
+
+	FRandomStream RandomStream(0x008);
+	FLineDescriptor LineDescriptor;
+	LineDescriptor.SetCurvePointsWithAutoTangents(MakeRandomPoints(RandomStream, 12));
+	TSharedRef<SHeadlessLineDrawer> Drawer = SNew(SHeadlessLineDrawer);
+	const int32 LineIndex = Drawer->AddLine(LineDescriptor);
+	Paint(*Drawer);
+
+	// Keys edited directly and through SetPoint in the same update, then in a second update before the line is painted again.
+	Drawer->UpdateLine(LineIndex, [](FLineDescriptor& OutLineDescriptor)
+	{
+		OutLineDescriptor.InterpCurve.Points[2].OutVal.Y += 40.0f;
+		OutLineDescriptor.SetPoint(8, OutLineDescriptor.InterpCurve.Points[8].OutVal + FVector2f(0.0f, -30.0f));
+		return true;
+	});
+	Drawer->UpdateLine(LineIndex, [](FLineDescriptor& OutLineDescriptor)
+	{
+		OutLineDescriptor.InterpCurve.Points[5].LeaveTangent *= 2.0f;
+		return true;
+	});
+	Paint(*Drawer);
+
+	// A copy of the edited descriptor is sampled from scratch, the re-sampled intervals must come out the same.
+	TSharedRef<SHeadlessLineDrawer> Reference = SNew(SHeadlessLineDrawer);
+	const int32 ReferenceIndex = Reference->AddLine(*Drawer->GetLine(LineIndex));
+	Paint(*Reference);
+	TestTrue(TEXT("Partially re-sampled curve matches a full sampling"), Algo::Compare(Drawer->GetLinePoints(LineIndex), Reference->GetLinePoints(ReferenceIndex)));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLineDrawerLineCommandsTest, "Plugins.AdvancedLineDrawer.LineCommands", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FLineDrawerLineCommandsTest::RunTest(const FString& Parameters)
+{
+	TSharedRef<SHeadlessLineDrawer> Drawer = SNew(SHeadlessLineDrawer);
+	FLineDescriptor LineDescriptor;
+	LineDescriptor.SetCurvePointsWithAutoTangents({ FVector2f(100.0f, 100.0f), FVector2f(300.0f, 200.0f) });
+	auto WithThickness = [&LineDescriptor](float Thickness)
+	{
+		FLineDescriptor Result = LineDescriptor;
+		Result.Thickness = Thickness;
+		return Result;
+	};
+	auto GetThickness = [&Drawer](int32 LineHandle)
+	{
+		const int32 LineIndex = Drawer->GetLineOfHandle(LineHandle);
+		return LineIndex != INDEX_NONE ? Drawer->GetLine(LineIndex)->Thickness : -1.0f;
+	};
+
+	// All in one batch, folded in the order they were enqueued.
+	const TArray<int32> LineHandles = Drawer->ReserveLineHandles(4);
+	Drawer->EnqueueAddLine(LineHandles[0], WithThickness(1.0f));
+	Drawer->EnqueueRemoveLine(LineHandles[0]);
+	Drawer->EnqueueAddLine(LineHandles[0], WithThickness(2.0f));
+	Drawer->EnqueueAddLine(LineHandles[1], WithThickness(1.0f));
+	Drawer->EnqueueUpdateLine(LineHandles[1], WithThickness(2.0f));
+	Drawer->EnqueueRemoveLine(LineHandles[1]);
+	Drawer->EnqueueUpdateLine(LineHandles[2], WithThickness(1.0f));
+	Drawer->EnqueueAddLine(LineHandles[2], WithThickness(2.0f));
+	Drawer->EnqueueAddLine(LineHandles[3], WithThickness(1.0f));
+	Drawer->FlushLineCommands();
+	TestEqual(TEXT("Added back after a remove"), GetThickness(LineHandles[0]), 2.0f);
+	TestEqual(TEXT("Removed after its updates"), GetThickness(LineHandles[1]), -1.0f);
+	TestEqual(TEXT("Update before the add dropped"), GetThickness(LineHandles[2]), 2.0f);
+
+	// Against the lines added by the previous batch.
+	Drawer->EnqueueRemoveLine(LineHandles[0]);
+	Drawer->EnqueueAddLine(LineHandles[0], WithThickness(3.0f));
+	Drawer->EnqueueUpdateLine(LineHandles[0], WithThickness(4.0f));
+	Drawer->EnqueueUpdateLine(LineHandles[2], WithThickness(3.0f));
+	Drawer->EnqueueRemoveLine(LineHandles[2]);
+	Drawer->FlushLineCommands();
+	TestEqual(TEXT("Existing line added back and updated"), GetThickness(LineHandles[0]), 4.0f);
+	TestEqual(TEXT("Existing line removed"), GetThickness(LineHandles[2]), -1.0f);
+
+	// A line removed directly loses its handle, released handles lose their line and are handed out again.
+	Drawer->RemoveLine(Drawer->GetLineOfHandle(LineHandles[3]));
+	TestEqual(TEXT("Handle of a line removed directly"), Drawer->GetLineOfHandle(LineHandles[3]), int32(INDEX_NONE));
+	Drawer->EnqueueReleaseLineHandle(LineHandles[0]);
+	Drawer->FlushLineCommands();
+	TestEqual(TEXT("Line of a released handle removed"), Drawer->GetAllLines().Num(), 0);
+	TestTrue(TEXT("Released handle handed out again"), Drawer->ReserveLineHandles(1) == TArray<int32>({ LineHandles[0] }));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLineDrawerLinesSnapshotTest, "Plugins.AdvancedLineDrawer.LinesSnapshot", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FLineDrawerLinesSnapshotTest::RunTest(const FString& Parameters)
+{
+	using namespace LineDrawerTests;
+
+	FRandomStream RandomStream(0x024);
+	TSharedRef<SHeadlessLineDrawer> Drawer = SNew(SHeadlessLineDrawer);
+	FLineDescriptor LineDescriptor;
+	LineDescriptor.SetCurvePointsWithAutoTangents(MakeRandomPoints(RandomStream, 8));
+	const int32 LineIndex = Drawer->AddLine(LineDescriptor);
+	Paint(*Drawer);
+	TArray<uint8> Snapshot;
+	Drawer->SaveLinesSnapshot(Snapshot, true);
+
+	// Read in place, and from a copy when the blob is off the alignment of the arrays it holds.
+	TSharedRef<SHeadlessLineDrawer> Loaded = SNew(SHeadlessLineDrawer);
+	TestTrue(TEXT("Snapshot loads"), Loaded->LoadLinesSnapshot(Snapshot));
+	TestTrue(TEXT("Loaded samples match"), Algo::Compare(Drawer->GetLinePoints(LineIndex), Loaded->GetLinePoints(LineIndex)));
+	TArray<uint8> Unaligned;
+	Unaligned.Add(0);
+	Unaligned.Append(Snapshot);
+	TestTrue(TEXT("Unaligned snapshot loads"), Loaded->LoadLinesSnapshot(TConstArrayView<uint8>(Unaligned).RightChop(1)));
+	TestTrue(TEXT("Unaligned samples match"), Algo::Compare(Drawer->GetLinePoints(LineIndex), Loaded->GetLinePoints(LineIndex)));
+
+	// Rejected blobs keep the lines.
+	TArray<uint8> Truncated = Snapshot;
+	Truncated.SetNum(Snapshot.Num() / 2);
+	TestFalse(TEXT("Truncated snapshot rejected"), Loaded->LoadLinesSnapshot(Truncated));
+	TArray<uint8> Swapped = Snapshot;
+	Algo::Reverse(Swapped.GetData(), sizeof(uint32));
+	TestFalse(TEXT("Snapshot of the other byte order rejected"), Loaded->LoadLinesSnapshot(Swapped));
+	TestTrue(TEXT("Lines kept"), Loaded->GetLine(LineIndex) != nullptr);
+
+	// A single line left at index 257 among removed ones. Its record starts the first section after the header, on 16 bytes, with
+	// the line index, brush index 0 and first key 0 as its first fields.
+	TSharedRef<SHeadlessLineDrawer> Sparse = SNew(SHeadlessLineDrawer);
+	constexpr int32 SparseLineIndex = 257;
+	TArray<int32> SparseLines;
+	for (int32 Index = 0; Index <= SparseLineIndex + 8; ++Index)
+	{
+		SparseLines.Add(Sparse->AddLine(LineDescriptor));
+	}
+	SparseLines.Remove(SparseLineIndex);
+	Sparse->RemoveLines(SparseLines);
+	TArray<uint8> SparseSnapshot;
+	Sparse->SaveLinesSnapshot(SparseSnapshot);
+	int32 RecordOffset = INDEX_NONE;
+	for (int32 Offset = 16; Offset + 3 * static_cast<int32>(sizeof(int32)) <= SparseSnapshot.Num() && RecordOffset == INDEX_NONE; Offset += 16)
+	{
+		const int32* Fields = reinterpret_cast<const int32*>(SparseSnapshot.GetData() + Offset);
+		RecordOffset = Fields[0] == SparseLineIndex && Fields[1] == 0 && Fields[2] == 0 ? Offset : INDEX_NONE;
+	}
+	if (TestTrue(TEXT("Line record found"), RecordOffset != INDEX_NONE))
+	{
+		TestTrue(TEXT("Sparse snapshot loads"), Loaded->LoadLinesSnapshot(SparseSnapshot) && Loaded->GetLine(SparseLineIndex) != nullptr);
+		for (const int32 CorruptLineIndex : { int32(MAX_int32), 1 << 30, SparseLineIndex + 1000, -1 })
+		{
+			TArray<uint8> Corrupt = SparseSnapshot;
+			*reinterpret_cast<int32*>(Corrupt.GetData() + RecordOffset) = CorruptLineIndex;
+			TestFalse(*FString::Printf(TEXT("Line index %d rejected"), CorruptLineIndex), Loaded->LoadLinesSnapshot(Corrupt));
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLineDrawerPaintTest, "Plugins.AdvancedLineDrawer.Paint", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FLineDrawerPaintTest::RunTest(const FString& Parameters)
+{
+	TSharedRef<SHeadlessLineDrawer> Drawer = SNew(SHeadlessLineDrawer);
+	FLineDescriptor LineDescriptor;
+	LineDescriptor.SetCurvePointsWithAutoTangents({ FVector2f(100.0f, 100.0f), FVector2f(300.0f, 200.0f), FVector2f(500.0f, 100.0f) });
+	const int32 LineIndex = Drawer->AddLine(LineDescriptor);
+	TestTrue(TEXT("Not sampled before the first paint"), Drawer->GetLinePoints(LineIndex).Num() == 0);
+
+	TestTrue(TEXT("Paint draws the line"), LineDrawerTests::Paint(*Drawer) > 0);
+	TestTrue(TEXT("Curve is sampled"), Drawer->GetLinePoints(LineIndex).Num() >= 3);
+
+	ILineDrawer::FLineHit Hit;
+	TestTrue(TEXT("Hit on a key"), Drawer->FindLineAt(FVector2f(300.0f, 200.0f), 1.0f, Hit) && Hit.LineIndex == LineIndex);
+	TestFalse(TEXT("No hit away from the line"), Drawer->FindLineAt(FVector2f(300.0f, 600.0f), 1.0f, Hit));
+
+	Drawer->RemoveLine(LineIndex);
+	TestEqual(TEXT("Nothing drawn once removed"), LineDrawerTests::Paint(*Drawer), 0);
+	return true;
+}
+
+#endif